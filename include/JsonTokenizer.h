@@ -0,0 +1,34 @@
+#pragma once
+
+#include <Print.h>
+
+/*
+ * Allocation-free JSON lexer over caller's buffer, tokens point into the buffer
+ */
+class JsonTokenizer {
+public:
+  enum token_t : uint8_t { JSON_ERROR, JSON_END, JSON_BEGIN_OBJECT, JSON_END_OBJECT, JSON_BEGIN_ARRAY, JSON_END_ARRAY,
+    JSON_COLON, JSON_COMMA, JSON_STRING, JSON_NUMBER, JSON_TRUE, JSON_FALSE, JSON_NULL };
+
+  JsonTokenizer(const char *json, uint16_t length) : _json(json), _length(length), _pos(0), _token(NULL), _tokenLength(0) {}
+
+  token_t next();
+  const char *token() const {
+    return _token;
+  }
+  uint16_t tokenLength() const {
+    return _tokenLength;
+  }
+  int16_t unescape(char *buf, uint16_t size) const; // Current JSON_STRING token without quotes and escapes, -1 if buffer too small
+
+  static size_t escape(Print &print, const char *str, uint16_t length); // Quoted JSON string
+
+protected:
+  bool match(const char *word);
+
+  const char *_json;
+  uint16_t _length;
+  uint16_t _pos;
+  const char *_token;
+  uint16_t _tokenLength;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "ParamStorage.h"
+
+/*
+ * Log-structured storage over a ring of flash sectors.
+ * Each commit appends one record with the byte runs changed since the previous commit,
+ * a sector is erased only when the current one is full and the whole image is compacted into the next one.
+ * Records and sectors are protected by CRC, so interrupted writes are ignored at the next begin().
+ * Optional seed storage (e.g. EEPROMStorage of previous firmware) supplies the image while the journal is empty.
+ * At least MIN_SECTORS are required: compaction erases the next sector, never the one holding the live image.
+ */
+class ParamJournal : public ParamStorage {
+public:
+  static const uint8_t MIN_SECTORS = 2;
+
+  ParamJournal(uint32_t sector, uint8_t sectors, ParamStorage *seed = NULL) : _sector(sector), _sectors(sectors), _seed(seed), _data(NULL), _shadow(NULL), _size(0) {}
+  ~ParamJournal();
+
+  bool begin(uint16_t size);
+  uint8_t *getDataPtr() {
+    return _data;
+  }
+  bool commit();
+
+protected:
+  static const uint32_t JOURNAL_SIGN = 0x4C4E524A; // "JRNL"
+  static const uint16_t SECTOR_SIZE = 4096;
+  static const uint8_t MAX_GAP = 8; // Unchanged bytes between two runs joined into one segment
+
+  struct sector_t {
+    uint32_t sign;
+    uint32_t sequence;
+  };
+  struct record_t {
+    uint16_t size; // Payload size, 0xFFFF for erased flash
+    uint16_t crc; // CRC16 of payload
+  };
+  struct __attribute__((__packed__)) segment_t {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  static uint16_t align(uint16_t size) {
+    return (size + 3) & ~3;
+  }
+
+  uint32_t address(uint8_t sector, uint16_t offset) const {
+    return (_sector + sector) * SECTOR_SIZE + offset;
+  }
+  bool replay(uint8_t sector);
+  bool append(const uint8_t *record, uint16_t size);
+  bool compact();
+
+  uint32_t _sector;
+  uint8_t _sectors;
+  ParamStorage *_seed;
+  uint8_t _current;
+  uint32_t _sequence;
+  uint16_t _position; // Offset of the next record in current sector
+  uint8_t *_data;
+  uint8_t *_shadow; // Image as it is stored in flash
+  uint16_t _size;
+};
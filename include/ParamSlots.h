@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ParamStorage.h"
+
+/*
+ * Two alternating flash sectors with generation counter.
+ * commit() writes the whole image into inactive sector and validates it by header written last,
+ * begin() loads the newest valid sector, so interrupted commit falls back to the previous image.
+ * Optional seed storage (e.g. EEPROMStorage of previous firmware) supplies the image while both sectors are empty.
+ */
+class ParamSlots : public ParamStorage {
+public:
+  static const uint8_t SECTORS = 2;
+
+  ParamSlots(uint32_t sector, ParamStorage *seed = NULL) : _sector(sector), _seed(seed), _data(NULL), _size(0) {}
+  ~ParamSlots();
+
+  bool begin(uint16_t size);
+  uint8_t *getDataPtr() {
+    return _data;
+  }
+  bool commit();
+
+protected:
+  static const uint32_t SLOT_SIGN = 0x544F4C53; // "SLOT"
+  static const uint16_t SECTOR_SIZE = 4096;
+
+  struct slot_t {
+    uint32_t sign;
+    uint32_t generation;
+    uint16_t size;
+    uint16_t crc;
+  };
+
+  static uint32_t align(uint16_t size) { // 32 bit not to wrap around on size of torn header
+    return (size + 3UL) & ~3UL;
+  }
+
+  uint32_t address(uint8_t slot, uint16_t offset) const {
+    return (_sector + slot) * SECTOR_SIZE + offset;
+  }
+  bool load(uint8_t slot, const slot_t &header);
+
+  uint32_t _sector;
+  ParamStorage *_seed;
+  uint8_t *_data;
+  uint16_t _size;
+  uint8_t _active;
+  uint32_t _generation;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+/*
+ * Backing store of Parameters image (header and data)
+ */
+class ParamStorage {
+public:
+  virtual ~ParamStorage() {}
+
+  virtual bool begin(uint16_t size) = 0;
+  virtual void end() {}
+  virtual uint8_t *getDataPtr() = 0;
+  virtual bool commit() = 0;
+};
+
+class EEPROMStorage : public ParamStorage {
+public:
+  bool begin(uint16_t size);
+  void end();
+  uint8_t *getDataPtr();
+  bool commit();
+};
+
+/*
+ * Image kept in heap, committed copy survives end() and begin() like flash does (for host builds and tests)
+ */
+class RAMStorage : public ParamStorage {
+public:
+  RAMStorage() : _data(NULL), _image(NULL), _size(0), _imageSize(0), _commits(0) {}
+  ~RAMStorage();
+
+  bool begin(uint16_t size);
+  void end();
+  uint8_t *getDataPtr();
+  bool commit();
+
+  uint32_t commits() const {
+    return _commits;
+  }
+
+protected:
+  uint8_t *_data, *_image;
+  uint16_t _size, _imageSize;
+  uint32_t _commits;
+};
+
+/*
+ * Image stored in file of mounted file system (LittleFS updates file atomically on close)
+ */
+class FileStorage : public ParamStorage {
+public:
+  FileStorage(fs::FS &fs, const char *path) : _fs(fs), _path(path), _data(NULL), _size(0) {}
+  ~FileStorage();
+
+  bool begin(uint16_t size);
+  void end();
+  uint8_t *getDataPtr();
+  bool commit();
+
+protected:
+  fs::FS &_fs;
+  const char *_path;
+  uint8_t *_data;
+  uint16_t _size;
+};
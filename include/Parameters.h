@@ -1,7 +1,11 @@
 #pragma once
 
 #include <functional>
+#include <utility>
+#include <stddef.h>
+#include <string.h>
 #include <Stream.h>
+#include "ParamStorage.h"
 #ifdef ESP8266
 #include <ESP8266WebServer.h>
 #else
@@ -13,18 +17,22 @@
 #endif
 
 #ifdef ESP8266
-static const char FALSE_PSTR[] PROGMEM = "false";
-static const char TRUE_PSTR[] PROGMEM = "true";
+static constexpr char FALSE_PSTR[] PROGMEM = "false";
+static constexpr char TRUE_PSTR[] PROGMEM = "true";
 
 static const char *const BOOLS[] PROGMEM = { FALSE_PSTR, TRUE_PSTR };
 #else
-static const char *const BOOLS[] = { "false", "true" };
+static constexpr const char *BOOLS[] = { "false", "true" };
 #endif
 
 enum cpevent_t : uint8_t { CP_INIT, CP_DONE, CP_RESTART, CP_WEB, CP_CONNECT, CP_DISCONNECT, CP_IDLE };
 
 typedef std::function<void(cpevent_t event, void *param)> cpcallback_t;
 
+typedef std::function<void(uint16_t index)> paramobserver_t;
+
+struct webasset_t;
+
 struct __attribute__((__packed__)) editor_t {
   enum editortype_t : uint8_t { EDIT_NONE, EDIT_TEXT, EDIT_PASSWORD, EDIT_TEXTAREA, EDIT_CHECKBOX, EDIT_RADIO, EDIT_SELECT, EDIT_HIDDEN };
 
@@ -46,13 +54,13 @@ struct __attribute__((__packed__)) editor_t {
       const char *uncheckedvalue;
     } checkbox;
     struct __attribute__((__packed__)) {
-      uint16_t count;
+      uint8_t count;
       const char *const *values;
       const char *const *titles;
     } radio;
     struct __attribute__((__packed__)) {
-      uint16_t size;
-      uint16_t count;
+      uint8_t size;
+      uint8_t count;
       const char *const *values;
       const char *const *titles;
     } select;
@@ -70,7 +78,7 @@ struct __attribute__((__packed__)) paraminfo_t {
     char aschar;
     const char *asstr;
     const uint8_t *asbinary;
-    const ipaddr_t asip;
+    ipaddr_t asip;
   };
   union __attribute__((__packed__)) number_t {
     int32_t asint;
@@ -83,8 +91,41 @@ struct __attribute__((__packed__)) paraminfo_t {
   paramtype_t type;
   uint16_t size;
   paramvalue_t defvalue;
-  editor_t editor;
   number_t minvalue, maxvalue;
+  editor_t editor; // Last, the leading fields are shared with paramdesc_t
+};
+
+// Parameter descriptor of compact schema, paraminfo_t without editor
+struct __attribute__((__packed__)) paramdesc_t {
+  const char *name;
+  const char *title;
+  paraminfo_t::paramtype_t type;
+  uint16_t size;
+  paraminfo_t::paramvalue_t defvalue;
+  paraminfo_t::number_t minvalue, maxvalue;
+};
+
+static_assert(offsetof(paraminfo_t, editor) == sizeof(paramdesc_t), "paramdesc_t must match leading fields of paraminfo_t!");
+
+/*
+ * Variable-length editor record of compact schema (see PARAMS_SCHEMA), starts with byte of type and flags:
+ * EDIT_TEXT, EDIT_PASSWORD: size, maxlength (uint16_t if WIDE, uint8_t otherwise)
+ * EDIT_TEXTAREA: cols, rows, maxlength (uint16_t if WIDE, uint8_t otherwise)
+ * EDIT_CHECKBOX: uint16_t offsets of checked and unchecked value strings in the same data
+ * EDIT_RADIO: count, values and titles list indexes
+ * EDIT_SELECT: size, count, values and titles list indexes
+ * EDIT_NONE, EDIT_HIDDEN: nothing
+ */
+struct parameditor_t {
+  static const uint8_t TYPE_MASK = 0x07;
+  static const uint8_t DISABLED = 0x08;
+  static const uint8_t REQUIRED = 0x10;
+  static const uint8_t READONLY = 0x20;
+  static const uint8_t WIDE = 0x40;
+  static const uint16_t NO_STRING = 0xFFFF;
+  static const uint8_t NO_LIST = 0xFF;
+  static const uint16_t MAX_DATA = 4096;
+  static const uint8_t MAX_LISTS = 255;
 };
 
 #define EDITOR_NONE() { .type = editor_t::EDIT_NONE }
@@ -102,19 +143,19 @@ struct __attribute__((__packed__)) paraminfo_t {
 #else
 #define PARAM_BOOL(n, t, d) PARAM_BOOL_CUSTOM(n, t, d, EDITOR_CHECKBOX(BOOLS[true], BOOLS[false], false, false, false))
 #endif
-#define PARAM_I8_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I8, .size = sizeof(int8_t), .defvalue = { .asint = (d) }, .editor = e, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) } }
+#define PARAM_I8_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I8, .size = sizeof(int8_t), .defvalue = { .asint = (d) }, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) }, .editor = e }
 #define PARAM_I8(n, t, d) PARAM_I8_CUSTOM(n, t, d, -128, 127, EDITOR_TEXT(3, 4, false, false, false))
-#define PARAM_U8_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U8, .size = sizeof(uint8_t), .defvalue = { .asuint = (d) }, .editor = e, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) } }
+#define PARAM_U8_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U8, .size = sizeof(uint8_t), .defvalue = { .asuint = (d) }, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) }, .editor = e }
 #define PARAM_U8(n, t, d) PARAM_U8_CUSTOM(n, t, d, 0, 255, EDITOR_TEXT(3, 3, false, false, false))
-#define PARAM_I16_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I16, .size = sizeof(int16_t), .defvalue = { .asint = (d) }, .editor = e, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) } }
+#define PARAM_I16_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I16, .size = sizeof(int16_t), .defvalue = { .asint = (d) }, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) }, .editor = e }
 #define PARAM_I16(n, t, d) PARAM_I16_CUSTOM(n, t, d, -32768, 32767, EDITOR_TEXT(5, 6, false, false, false))
-#define PARAM_U16_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U16, .size = sizeof(uint16_t), .defvalue = { .asuint = (d) }, .editor = e, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) } }
+#define PARAM_U16_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U16, .size = sizeof(uint16_t), .defvalue = { .asuint = (d) }, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) }, .editor = e }
 #define PARAM_U16(n, t, d) PARAM_U16_CUSTOM(n, t, d, 0, 65535, EDITOR_TEXT(5, 5, false, false, false))
-#define PARAM_I32_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I32, .size = sizeof(int32_t), .defvalue = { .asint = (d) }, .editor = e, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) } }
+#define PARAM_I32_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_I32, .size = sizeof(int32_t), .defvalue = { .asint = (d) }, .minvalue = { .asint = (m) }, .maxvalue = { .asint = (x) }, .editor = e }
 #define PARAM_I32(n, t, d) PARAM_I32_CUSTOM(n, t, d, -2147483648L, 2147483647L, EDITOR_TEXT(10, 11, false, false, false))
-#define PARAM_U32_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U32, .size = sizeof(uint32_t), .defvalue = { .asuint = (d) }, .editor = e, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) } }
+#define PARAM_U32_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_U32, .size = sizeof(uint32_t), .defvalue = { .asuint = (d) }, .minvalue = { .asuint = (m) }, .maxvalue = { .asuint = (x) }, .editor = e }
 #define PARAM_U32(n, t, d) PARAM_U32_CUSTOM(n, t, d, 0, 4294967295UL, EDITOR_TEXT(10, 10, false, false, false))
-#define PARAM_FLOAT_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_FLOAT, .size = sizeof(float), .defvalue = { .asfloat = (d) }, .editor = e, .minvalue = { .asfloat = (m) }, .maxvalue = { .asfloat = (x) } }
+#define PARAM_FLOAT_CUSTOM(n, t, d, m, x, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_FLOAT, .size = sizeof(float), .defvalue = { .asfloat = (d) }, .minvalue = { .asfloat = (m) }, .maxvalue = { .asfloat = (x) }, .editor = e }
 #define PARAM_FLOAT(n, t, d) PARAM_FLOAT_CUSTOM(n, t, d, NAN, NAN, EDITOR_TEXT(10, 15, false, false, false))
 #define PARAM_CHAR_CUSTOM(n, t, d, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_CHAR, .size = sizeof(char), .defvalue = { .aschar = (d) }, .editor = e }
 #define PARAM_CHAR(n, t, d) PARAM_CHAR_CUSTOM(n, t, d, EDITOR_TEXT(1, 1, false, false, false))
@@ -126,9 +167,299 @@ struct __attribute__((__packed__)) paraminfo_t {
 #define PARAM_IP_CUSTOM(n, t, d1, d2, d3, d4, e) { .name = (n), .title = (t), .type = paraminfo_t::PARAM_IP, .size = sizeof(paraminfo_t::ipaddr_t), .defvalue = { .asip = { (d1), (d2), (d3), (d4) }  }, .editor = e }
 #define PARAM_IP(n, t, d1, d2, d3, d4) PARAM_IP_CUSTOM(n, t, d1, d2, d3, d4, EDITOR_TEXT(15, 15, false, false, false))
 
+template<typename T> struct paramtraits_t;
+template<> struct paramtraits_t<bool> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_BOOL; }
+};
+template<> struct paramtraits_t<int8_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_I8; }
+};
+template<> struct paramtraits_t<uint8_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_U8; }
+};
+template<> struct paramtraits_t<int16_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_I16; }
+};
+template<> struct paramtraits_t<uint16_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_U16; }
+};
+template<> struct paramtraits_t<int32_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_I32; }
+};
+template<> struct paramtraits_t<uint32_t> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_U32; }
+};
+template<> struct paramtraits_t<float> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_FLOAT; }
+};
+template<> struct paramtraits_t<char> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_CHAR; }
+};
+template<> struct paramtraits_t<const char*> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return type == paraminfo_t::PARAM_STR; }
+};
+template<> struct paramtraits_t<const uint8_t*> {
+  static constexpr bool accepts(paraminfo_t::paramtype_t type) { return (type == paraminfo_t::PARAM_BINARY) || (type == paraminfo_t::PARAM_IP); }
+};
+
+/*
+ * Typed handle of parameter with fixed index in the parameters table,
+ * e.g. "constexpr paramkey_t<bool, 2> PARAM_PERSISTENT;"
+ * Scalars are returned by value, PARAM_STR as const char* and PARAM_BINARY/PARAM_IP as const uint8_t*
+ */
+template<typename T, uint16_t I> struct paramkey_t {
+  typedef T type;
+  static constexpr uint16_t index = I;
+};
+
+// Use with static_assert() on constexpr parameters table to check index, name and type of the handle
+template<typename T, uint16_t I, size_t N> constexpr bool paramKeyValid(const paraminfo_t (&params)[N], paramkey_t<T, I>, const char *name) {
+  return (I < N) && (params[I].name == name) && paramtraits_t<T>::accepts(params[I].type);
+}
+
+/*
+ * Compile-time checks of parameters table, e.g. "static_assert(paramsValid(PARAMS), "Wrong parameters!");"
+ */
+constexpr uint16_t paramStrLen(const char *str) {
+  return *str ? paramStrLen(str + 1) + 1 : 0;
+}
+
+constexpr int8_t paramStrCmp(const char *s1, const char *s2) {
+  return (*s1 != *s2) ? (*s1 < *s2 ? -1 : 1) : (*s1 ? paramStrCmp(s1 + 1, s2 + 1) : 0);
+}
+
+// Fields are grouped by natural alignment, PARAM_BOOL fields are packed into bitset (0)
+constexpr uint8_t paramAlignment(paraminfo_t::paramtype_t type) {
+  return type == paraminfo_t::PARAM_BOOL ? 0 :
+    (type == paraminfo_t::PARAM_I16) || (type == paraminfo_t::PARAM_U16) ? sizeof(uint16_t) :
+    (type == paraminfo_t::PARAM_I32) || (type == paraminfo_t::PARAM_U32) || (type == paraminfo_t::PARAM_FLOAT) ? sizeof(uint32_t) : 1;
+}
+
+constexpr bool paramRangeValid(const paraminfo_t &param) {
+  return (param.type == paraminfo_t::PARAM_I8) || (param.type == paraminfo_t::PARAM_I16) || (param.type == paraminfo_t::PARAM_I32) ?
+    (param.minvalue.asint <= param.maxvalue.asint) && (param.defvalue.asint >= param.minvalue.asint) && (param.defvalue.asint <= param.maxvalue.asint) :
+    (param.type == paraminfo_t::PARAM_U8) || (param.type == paraminfo_t::PARAM_U16) || (param.type == paraminfo_t::PARAM_U32) ?
+    (param.minvalue.asuint <= param.maxvalue.asuint) && (param.defvalue.asuint >= param.minvalue.asuint) && (param.defvalue.asuint <= param.maxvalue.asuint) :
+    param.type == paraminfo_t::PARAM_FLOAT ? // NAN means no limit
+    ((param.minvalue.asfloat != param.minvalue.asfloat) || (param.maxvalue.asfloat != param.maxvalue.asfloat) || (param.minvalue.asfloat <= param.maxvalue.asfloat)) &&
+    ((param.minvalue.asfloat != param.minvalue.asfloat) || (param.defvalue.asfloat >= param.minvalue.asfloat)) &&
+    ((param.maxvalue.asfloat != param.maxvalue.asfloat) || (param.defvalue.asfloat <= param.maxvalue.asfloat)) : true;
+}
+
+constexpr bool paramValid(const paraminfo_t &param) {
+  return param.name && *param.name && param.size &&
+    ((param.type != paraminfo_t::PARAM_STR) || (! param.defvalue.asstr) || (paramStrLen(param.defvalue.asstr) < param.size)) &&
+    paramRangeValid(param);
+}
+
+template<size_t N> constexpr bool paramNameUnique(const paraminfo_t (&params)[N], size_t index, size_t other) {
+  return (other >= N) || (paramStrCmp(params[index].name, params[other].name) && paramNameUnique(params, index, other + 1));
+}
+
+template<size_t N> constexpr bool paramsValid(const paraminfo_t (&params)[N], size_t index = 0) {
+  return (index >= N) || (paramValid(params[index]) && paramNameUnique(params, index, index + 1) && paramsValid(params, index + 1));
+}
+
+// Size of parameters data (without header and directory)
+template<size_t N> constexpr uint16_t paramsDataSize(const paraminfo_t (&params)[N], size_t index = 0, uint16_t bits = 0) {
+  return index >= N ? (bits + 7) / 8 :
+    params[index].type == paraminfo_t::PARAM_BOOL ? paramsDataSize(params, index + 1, bits + 1) :
+    params[index].size + paramsDataSize(params, index + 1, bits);
+}
+
+#if __cplusplus >= 201402L
+/*
+ * Data offsets and name index built at compile time, saves begin() from computing them:
+ * "PARAMS_LAYOUT(LAYOUT, PARAMS); Parameters params(PARAMS, LAYOUT);"
+ */
+template<size_t N> struct paramlayout_t {
+  uint16_t offsets[N];
+  uint16_t sorted[N];
+  uint16_t dataSize;
+  uint16_t bitsOffset;
+};
+
+template<size_t N> constexpr paramlayout_t<N> paramLayout(const paraminfo_t (&params)[N]) {
+  paramlayout_t<N> result = {};
+  uint16_t bits = 0;
+
+  for (uint8_t align = 4; align; align >>= 1) {
+    for (size_t i = 0; i < N; ++i) {
+      if (paramAlignment(params[i].type) == align) {
+        result.offsets[i] = result.dataSize;
+        result.dataSize += params[i].size;
+      }
+    }
+  }
+  result.bitsOffset = result.dataSize;
+  for (size_t i = 0; i < N; ++i) {
+    if (params[i].type == paraminfo_t::PARAM_BOOL)
+      result.offsets[i] = bits++;
+  }
+  result.dataSize += (bits + 7) / 8;
+  for (size_t i = 0; i < N; ++i) {
+    size_t j = i;
+
+    while (j && (paramStrCmp(params[result.sorted[j - 1]].name, params[i].name) > 0)) {
+      result.sorted[j] = result.sorted[j - 1];
+      --j;
+    }
+    result.sorted[j] = i;
+  }
+  return result;
+}
+
+#define PARAMS_LAYOUT(l, p) \
+  static_assert(paramsValid(p), "Wrong parameters table " #p " (empty or duplicate name, too long default string or wrong range)!"); \
+  constexpr paramlayout_t<ARRAY_SIZE(p)> l = paramLayout(p)
+
+/*
+ * Compact schema built at compile time from parameters table: descriptors without editor_t and
+ * variable-length editor records found by offset index. Identical records and checkbox strings are stored once.
+ * Table itself is not referenced and does not take flash, checkbox values in it must be constexpr strings:
+ * "PARAMS_LAYOUT(LAYOUT, PARAMS); PARAMS_SCHEMA(SCHEMA, PARAMS); Parameters params(SCHEMA, LAYOUT);"
+ */
+template<size_t N, size_t S, size_t L> struct parameditors_t {
+  uint16_t index[N]; // Offset of editor record of each parameter in data
+  const char *const *lists[L]; // Values and titles of EDIT_RADIO and EDIT_SELECT
+  uint8_t data[S]; // Records and strings
+  uint16_t size; // Used bytes of data
+  uint8_t count; // Used lists
+};
+
+template<size_t N, size_t S, size_t L> struct paramschema_t {
+  paramdesc_t params[N];
+  parameditors_t<N, S, L> editors;
+};
+
+// Appends bytes unless the same sequence is already in data, returns its offset
+template<size_t N, size_t S, size_t L, typename T> constexpr uint16_t paramEditorBytes(parameditors_t<N, S, L> &editors, const T *bytes, uint16_t len) {
+  for (uint16_t offset = 0; offset + len <= editors.size; ++offset) {
+    uint16_t i = 0;
+
+    while ((i < len) && (editors.data[offset + i] == (uint8_t)bytes[i]))
+      ++i;
+    if (i == len)
+      return offset;
+  }
+  for (uint16_t i = 0; i < len; ++i)
+    editors.data[editors.size + i] = bytes[i];
+  editors.size += len;
+  return editors.size - len;
+}
+
+template<size_t N, size_t S, size_t L> constexpr uint16_t paramEditorString(parameditors_t<N, S, L> &editors, const char *str) {
+  return str ? paramEditorBytes(editors, str, paramStrLen(str) + 1) : parameditor_t::NO_STRING;
+}
+
+template<size_t N, size_t S, size_t L> constexpr uint8_t paramEditorList(parameditors_t<N, S, L> &editors, const char *const *list) {
+  if (! list)
+    return parameditor_t::NO_LIST;
+  for (uint8_t i = 0; i < editors.count; ++i) {
+    if (editors.lists[i] == list)
+      return i;
+  }
+  editors.lists[editors.count] = list;
+  return editors.count++;
+}
+
+template<size_t N, size_t S, size_t L> constexpr uint16_t paramEditorRecord(parameditors_t<N, S, L> &editors, const editor_t &editor) {
+  uint8_t record[7] = {};
+  uint8_t len = 1;
+  uint16_t numbers[3] = {};
+  uint8_t count = 0;
+
+  record[0] = editor.type | (editor.disabled ? parameditor_t::DISABLED : 0) | (editor.required ? parameditor_t::REQUIRED : 0) |
+    (editor.readonly ? parameditor_t::READONLY : 0);
+  if ((editor.type == editor_t::EDIT_TEXT) || (editor.type == editor_t::EDIT_PASSWORD)) {
+    numbers[count++] = editor.text.size;
+    numbers[count++] = editor.text.maxlength;
+  } else if (editor.type == editor_t::EDIT_TEXTAREA) {
+    numbers[count++] = editor.textarea.cols;
+    numbers[count++] = editor.textarea.rows;
+    numbers[count++] = editor.textarea.maxlength;
+  } else if (editor.type == editor_t::EDIT_CHECKBOX) {
+    numbers[0] = paramEditorString(editors, editor.checkbox.checkedvalue);
+    numbers[1] = paramEditorString(editors, editor.checkbox.uncheckedvalue);
+    record[0] |= parameditor_t::WIDE;
+    count = 2;
+  } else if (editor.type == editor_t::EDIT_RADIO) {
+    record[len++] = editor.radio.count;
+    record[len++] = paramEditorList(editors, editor.radio.values);
+    record[len++] = paramEditorList(editors, editor.radio.titles);
+  } else if (editor.type == editor_t::EDIT_SELECT) {
+    record[len++] = editor.select.size;
+    record[len++] = editor.select.count;
+    record[len++] = paramEditorList(editors, editor.select.values);
+    record[len++] = paramEditorList(editors, editor.select.titles);
+  }
+  for (uint8_t i = 0; i < count; ++i) {
+    if (numbers[i] > 0xFF)
+      record[0] |= parameditor_t::WIDE;
+  }
+  for (uint8_t i = 0; i < count; ++i) {
+    record[len++] = numbers[i];
+    if (record[0] & parameditor_t::WIDE)
+      record[len++] = numbers[i] >> 8;
+  }
+  return paramEditorBytes(editors, record, len);
+}
+
+template<size_t S, size_t L, size_t N> constexpr parameditors_t<N, S, L> paramEditors(const paraminfo_t (&params)[N]) {
+  parameditors_t<N, S, L> result = {};
+
+  for (size_t i = 0; i < N; ++i)
+    result.index[i] = paramEditorRecord(result, params[i].editor);
+  return result;
+}
+
+// Used data bytes and lists, sizes of paramschema_t
+template<size_t N> constexpr uint16_t paramEditorsSize(const paraminfo_t (&params)[N]) {
+  return paramEditors<parameditor_t::MAX_DATA, parameditor_t::MAX_LISTS>(params).size;
+}
+
+template<size_t N> constexpr uint8_t paramEditorsLists(const paraminfo_t (&params)[N]) {
+  return paramEditors<parameditor_t::MAX_DATA, parameditor_t::MAX_LISTS>(params).count;
+}
+
+constexpr paramdesc_t paramDesc(const paraminfo_t &param) {
+  return { param.name, param.title, param.type, param.size, param.defvalue, param.minvalue, param.maxvalue };
+}
+
+template<size_t S, size_t L, size_t N, size_t... I> constexpr paramschema_t<N, S, L> paramSchema(const paraminfo_t (&params)[N], std::index_sequence<I...>) {
+  return { { paramDesc(params[I])... }, paramEditors<S, L>(params) };
+}
+
+#define PARAMS_SCHEMA(s, p) \
+  constexpr paramschema_t<ARRAY_SIZE(p), paramEditorsSize(p), paramEditorsLists(p) ? paramEditorsLists(p) : 1> s PROGMEM = \
+    paramSchema<paramEditorsSize(p), paramEditorsLists(p) ? paramEditorsLists(p) : 1>(p, std::make_index_sequence<ARRAY_SIZE(p)>())
+#endif
+
 class Parameters {
 public:
-  Parameters(const paraminfo_t *params, uint16_t cnt) : _params(params), _count(cnt), _inited(false) {}
+  Parameters(const paraminfo_t *params, uint16_t cnt, ParamStorage *storage = NULL);
+#if __cplusplus >= 201402L
+  template<size_t N> Parameters(const paraminfo_t (&params)[N], const paramlayout_t<N> &layout, ParamStorage *storage = NULL) :
+    Parameters(params, N, storage) {
+    _offsets = layout.offsets;
+    _sorted = layout.sorted;
+    _dataSize = layout.dataSize;
+    _bitsOffset = layout.bitsOffset;
+  }
+  template<size_t N, size_t S, size_t L> Parameters(const paramschema_t<N, S, L> &schema, const paramlayout_t<N> &layout, ParamStorage *storage = NULL) :
+    Parameters(NULL, N, storage) {
+    _params = (const uint8_t*)schema.params;
+    _stride = sizeof(paramdesc_t);
+    _editorIndex = schema.editors.index;
+    _editorLists = schema.editors.lists;
+    _editorData = schema.editors.data;
+    _offsets = layout.offsets;
+    _sorted = layout.sorted;
+    _dataSize = layout.dataSize;
+    _bitsOffset = layout.bitsOffset;
+  }
+#endif
+  ~Parameters();
 
   bool begin();
   operator bool() {
@@ -138,24 +469,33 @@ public:
     return _count;
   }
   int16_t find(const char *name) const;
-  const paraminfo_t *getInfo(uint16_t index) const;
+  bool getInfo(uint16_t index, paraminfo_t &info) const; // Decoded copy, also of compact schema
   const char *name(uint16_t index) const;
   paraminfo_t::paramtype_t type(uint16_t index) const;
   uint16_t size(uint16_t index) const;
   uint16_t size(const char *name) const {
     return size(find(name));
   }
-#ifdef ESP8266
   const void *value(uint16_t index) const;
-#else
-  const void *value(uint16_t index) const {
-    return getPtr(index);
-  }
-#endif
   const void *value(const char *name) const {
     return value(find(name));
   }
+  template<typename T, uint16_t I> T value(paramkey_t<T, I>) const {
+    return valueAs<T>(I);
+  }
   bool update();
+  bool flush();
+  void handle();
+  bool beginTransaction();
+  bool commit();
+  void rollback();
+  bool inTransaction() const {
+    return _txData != NULL;
+  }
+  void setCommitDelay(uint32_t quiet, uint32_t latency) {
+    _commitQuiet = quiet;
+    _commitLatency = latency;
+  }
   bool clear();
   void clear(uint16_t index);
   void clear(const char *name) {
@@ -169,6 +509,15 @@ public:
   bool set(const char *name, const void *data) {
     return set(find(name), data);
   }
+  template<typename T, uint16_t I> bool set(paramkey_t<T, I>, const typename paramkey_t<T, I>::type &data) {
+    return set(I, &data);
+  }
+  template<uint16_t I> bool set(paramkey_t<const char*, I>, const char *data) {
+    return set(I, data);
+  }
+  template<uint16_t I> bool set(paramkey_t<const uint8_t*, I>, const uint8_t *data) {
+    return set(I, data);
+  }
   String toString(uint16_t index, bool encode = false);
   String toString(const char *name, bool encode = false) {
     return toString(find(name), encode);
@@ -186,38 +535,146 @@ public:
     return fromStream(find(name), stream);
   }
 
+  bool onChange(int16_t index, paramobserver_t observer); // index -1 to observe all parameters
+  bool onChange(const char *name, paramobserver_t observer) {
+    int16_t index = find(name);
+
+    if (index < 0)
+      return false;
+    return onChange(index, observer);
+  }
+  template<typename T, uint16_t I> bool onChange(paramkey_t<T, I>, paramobserver_t observer) {
+    return onChange(I, observer);
+  }
+
+  static uint16_t crc16(uint8_t data, uint16_t crc = 0xFFFF);
+  static uint16_t crc16(const uint8_t *data, uint16_t size, uint16_t crc = 0xFFFF);
+
+  bool toJson(Stream &stream);
+  bool fromJson(const char *json, uint16_t length);
+
+  // script is cacheable asset of editor helpers (web/params.js), NULL to inline them into every page
 #ifdef ESP8266
-  void handleWebPage(ESP8266WebServer &http, const char *restartPath = NULL, bool confirmation = true);
+  void handleWebPage(ESP8266WebServer &http, const webasset_t *script, const char *restartPath = NULL, bool confirmation = true);
+  void handleJson(ESP8266WebServer &http);
 #else
-  void handleWebPage(WebServer &http, const char *restartPath = NULL, bool confirmation = true);
+  void handleWebPage(WebServer &http, const webasset_t *script, const char *restartPath = NULL, bool confirmation = true);
+  void handleJson(WebServer &http);
 #endif
 
 protected:
-  static const uint16_t EEPROM_SIGN = 0xA55A;
+  static const uint16_t EEPROM_SIGN = 0xA55C;
+  static const uint16_t EEPROM_SIGN_ALIGNED = 0xA55B; // Aligned layout without directory
+  static const uint16_t EEPROM_SIGN_LEGACY = 0xA55A; // Unaligned layout
 
   struct __attribute__((__packed__)) header_t {
     uint16_t sign;
-    uint16_t crc;
+    uint16_t crc; // CRC of directory and data
+    uint16_t schema; // CRC of directory
+    uint16_t count; // Directory entries
+    uint16_t size; // Whole image size
   };
 
-  static uint16_t crc16(uint8_t data, uint16_t crc = 0xFFFF);
-  static uint16_t crc16(const uint8_t *data, uint16_t size, uint16_t crc = 0xFFFF);
+  // Directory entry stored after header_t, describes stored field to migrate it after parameters table changed
+  struct __attribute__((__packed__)) dirent_t {
+    uint16_t tag; // CRC of parameter name
+    paraminfo_t::paramtype_t type;
+    uint16_t size;
+  };
+
+  struct observer_t {
+    paramobserver_t callback;
+    observer_t *next;
+    int16_t index;
+  };
+
+  template<typename T> T valueAs(uint16_t index) const {
+    const void *ptr = getPtr(index);
 
+    if (ptr)
+      return *(const T*)ptr;
+    return T();
+  }
+
+  static uint16_t layout(const dirent_t *dir, uint16_t count, uint16_t *offsets, uint16_t &bitsOffset);
+  static uint16_t dataOffset(uint16_t count) {
+    return (sizeof(header_t) + count * sizeof(dirent_t) + 3) & ~3;
+  }
+  static int16_t findEntry(const dirent_t *dir, uint16_t count, const dirent_t &entry);
+
+  uint16_t nameTag(uint16_t index) const;
+
+  int8_t compareName(uint16_t index, const char *name) const;
+  uint8_t *getData() const {
+    return _txData ? _txData : _storage->getDataPtr() + _dataOffset;
+  }
   void *getPtr(uint16_t index) const;
+  bool getBit(uint16_t index) const;
+  void setBit(uint16_t index, bool value);
+  void markDirty(uint16_t index);
+  void clearDirty();
+  bool isDirty() const {
+    return _dirtyFrom < _dirtyTo;
+  }
+  const char *format(uint16_t index, char *buf) const; // buf must have FORMAT_SIZE chars, NULL for PARAM_BINARY
+  bool validate(uint16_t index) const;
+  bool parse(uint16_t index, const char *str);
+  bool complete(uint16_t index, bool result);
   bool check();
+  void writeDirectory(const dirent_t *dir);
+  bool migrate(const dirent_t *dir);
+  bool store();
+  bool takeSnapshot();
+  void notify();
 
-  String getScript();
-  String getEditor(uint16_t index);
+  const paramdesc_t *desc(uint16_t index) const { // Leading fields of paraminfo_t or compact schema descriptor
+    return (const paramdesc_t*)(_params + index * _stride);
+  }
+  const uint8_t *editorRecord(uint16_t index) const;
+  editor_t::editortype_t editorType(uint16_t index) const;
+  void getEditor(uint16_t index, editor_t &editor) const;
+  void editorToStream(uint16_t index, Stream &stream);
 
-  String encodeString(char c);
-  String encodeString(const char *str);
+  static size_t encodeString(Print &print, char c);
+  static size_t encodeString(Print &print, const char *str);
 
-  const paraminfo_t *_params;
-#ifdef ESP8266
-  uint8_t _alignedData[4];
-#endif
+  const uint8_t *_params; // paraminfo_t or paramdesc_t table, see desc()
+  const uint16_t *_editorIndex; // Compact schema editor records, NULL to use editor_t of paraminfo_t
+  const char *const *const *_editorLists;
+  const uint8_t *_editorData;
+  ParamStorage *_storage;
+  const uint16_t *_offsets; // Offsets of each parameter data from _dataOffset, filled in begin() or by paramLayout()
+  const uint16_t *_sorted; // Parameter indexes ordered by name for binary search in find(), filled in begin() or by paramLayout()
+  uint16_t _dataOffset; // Data follows header_t and directory
+  uint16_t _dataSize;
+  uint16_t _bitsOffset;
+  uint16_t _schema;
+  uint16_t _dirtyFrom, _dirtyTo; // Range of data changed since last update()
+  uint8_t *_txData; // Scratch copy of data while transaction is active
+  uint16_t _txDirtyFrom, _txDirtyTo; // Range changed before transaction
+  bool _txFailed;
+  uint32_t _commitQuiet, _commitLatency; // Deferred commit after quiet period or latency (in ms.) since first change, 0 to commit in update()
+  uint32_t _firstChange, _lastChange;
+  bool _pending;
+  observer_t *_observers;
+  uint8_t *_snapshot; // Copy of data at last commit to detect changed parameters for observers
+  bool _ownLayout; // _offsets and _sorted are allocated in begin()
+  uint8_t _stride; // Size of _params item
   uint16_t _count : 15;
   bool _inited : 1;
 };
 
-bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd, uint16_t duration = 0, cpcallback_t callback = NULL);
+template<> inline bool Parameters::valueAs<bool>(uint16_t index) const {
+  return _inited && (index < _count) && getBit(index);
+}
+
+template<> inline const char *Parameters::valueAs<const char*>(uint16_t index) const {
+  return (const char*)getPtr(index);
+}
+
+template<> inline const uint8_t *Parameters::valueAs<const uint8_t*>(uint16_t index) const {
+  return (const uint8_t*)getPtr(index);
+}
+
+bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd, uint16_t duration = 0, cpcallback_t callback = NULL,
+  const webasset_t *script = NULL);
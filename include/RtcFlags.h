@@ -13,3 +13,59 @@ public:
 protected:
   static const uint32_t RTC_SIGN = 0xA1B2C3D4;
 };
+
+/*
+ * Typed slots (up to 4 bytes each) in RTC user memory after RtcFlags, protected by CRC.
+ * Survive soft and watchdog resets, but not power loss.
+ * set() changes RAM copy only, commit() writes all changed slots at once.
+ */
+class RtcStore {
+public:
+  static const uint8_t SLOTS = 8;
+
+  static bool begin();
+  static bool has(uint8_t slot) {
+    return (slot < SLOTS) && (_data.mask & (1 << slot));
+  }
+  template<typename T> static T get(uint8_t slot, T def = T()) {
+    static_assert(sizeof(T) <= sizeof(uint32_t), "Type too large for RTC slot!");
+
+    if (has(slot)) {
+      T result;
+
+      memcpy(&result, &_data.slots[slot], sizeof(T));
+      return result;
+    }
+    return def;
+  }
+  template<typename T> static bool set(uint8_t slot, T value) {
+    static_assert(sizeof(T) <= sizeof(uint32_t), "Type too large for RTC slot!");
+
+    if (slot < SLOTS) {
+      uint32_t data = 0;
+
+      memcpy(&data, &value, sizeof(T));
+      if ((! has(slot)) || (_data.slots[slot] != data)) {
+        _data.slots[slot] = data;
+        _data.mask |= (1 << slot);
+        _dirty = true;
+      }
+      return true;
+    }
+    return false;
+  }
+  static void clear(uint8_t slot);
+  static bool commit();
+
+protected:
+  static const uint8_t OFFSET = 2; // RTC memory blocks used by RtcFlags
+
+  struct data_t {
+    uint32_t crc;
+    uint32_t mask;
+    uint32_t slots[SLOTS];
+  };
+
+  static data_t _data;
+  static bool _dirty;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Parameters.h"
+#include "RtcFlags.h"
+
+/*
+ * Frequently changed parameter mirrored in RtcStore slot. set() changes RAM copy only, RTC memory is written
+ * once per handle() (changes between loop() passes are batched) or by save(). New value is written to
+ * parameters storage (flash) only after it stays unchanged for delay ms, or by save() before planned restart.
+ * While RTC memory is valid its value wins over the stored one, so reload() must be called when the parameter
+ * is changed elsewhere (e.g. from onChange() observer).
+ * RtcStore::begin() must be called before begin().
+ */
+template<typename T> class RtcParam {
+public:
+  RtcParam(Parameters &params, uint16_t index, uint8_t slot, uint32_t delay) : _params(params), _delay(delay), _changed(0), _index(index), _slot(slot), _saved(), _pending(false) {}
+  template<uint16_t I> RtcParam(Parameters &params, paramkey_t<T, I>, uint8_t slot, uint32_t delay) : RtcParam(params, I, slot, delay) {}
+
+  void begin(bool restore = true) { // RTC value not stored before reset is scheduled again, or dropped if not restore
+    _saved = stored();
+    if (! restore) {
+      RtcStore::clear(_slot);
+      RtcStore::commit();
+    } else if (RtcStore::has(_slot) && (get() != _saved))
+      schedule();
+  }
+  T get() {
+    return RtcStore::get(_slot, stored());
+  }
+  bool set(T value) {
+    if (! RtcStore::set(_slot, value))
+      return false;
+    schedule();
+    return true;
+  }
+  void handle() {
+    RtcStore::commit();
+    if (_pending && (millis() - _changed >= _delay))
+      save();
+  }
+  bool save() {
+    reload(); // Not yet stored change of parameter wins
+
+    bool result = RtcStore::commit();
+
+    if (_pending) {
+      _saved = get();
+      _pending = false;
+      result = _params.set(_index, &_saved) && _params.update() && result;
+    }
+    return result;
+  }
+  void reload() { // Parameter changed not by save(): RTC value is dropped, so get() returns the new one
+    T value = stored();
+
+    if (value != _saved) {
+      _saved = value;
+      _pending = false;
+      RtcStore::clear(_slot);
+      RtcStore::commit();
+    }
+  }
+  bool pending() const {
+    return _pending;
+  }
+
+protected:
+  T stored() {
+    T result = T();
+
+    _params.get(_index, &result, sizeof(T));
+    return result;
+  }
+  void schedule() {
+    _changed = millis();
+    _pending = true;
+  }
+
+  Parameters &_params;
+  uint32_t _delay;
+  uint32_t _changed;
+  uint16_t _index;
+  uint8_t _slot;
+  T _saved; // Last value stored by begin(), save() or seen by reload()
+  bool _pending;
+};
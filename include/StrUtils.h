@@ -1,10 +1,34 @@
 #pragma once
 
+#include <stdint.h>
 #include <WString.h>
+#include <Stream.h>
 
 String printfToString(const char *fmt, ...);
 
 int8_t strcmp_PP(const char *s1, const char *s2);
 int8_t strncmp_PP(const char *s1, const char *s2, uint16_t maxlen);
 
-int sscanf_P(const char *str, const char *fmt, ...);
+/*
+ * Line oriented stream input: delimiter is CR, LF or CR LF and it is consumed with the line
+ */
+bool readLineChar(Stream &stream, char &c); // false at end of line or stream timeout
+void skipLine(Stream &stream); // Discard rest of line
+
+/*
+ * Parse whole string (surrounding spaces are allowed) without copying it, return false on syntax error or overflow
+ */
+bool parseInt(const char *str, int32_t &value, int32_t minvalue = INT32_MIN, int32_t maxvalue = INT32_MAX);
+bool parseUInt(const char *str, uint32_t &value, uint32_t maxvalue = UINT32_MAX);
+bool parseFloat(const char *str, float &value);
+bool parseIP(const char *str, uint8_t *ip);
+
+/*
+ * Format number into buffer (at least FORMAT_SIZE chars) without printf, return length of zero terminated result
+ */
+const uint8_t FORMAT_SIZE = 18;
+
+uint8_t formatInt(char *buf, int32_t value);
+uint8_t formatUInt(char *buf, uint32_t value);
+uint8_t formatFloat(char *buf, float value); // Shortest form that reads back to the same float
+uint8_t formatIP(char *buf, const uint8_t *ip);
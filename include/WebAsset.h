@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+ * Static web content, gzipped into PROGMEM by tools/web_assets.py (see WebAssets.h)
+ */
+struct webasset_t {
+  const uint8_t *data;
+  uint32_t size;
+  const char *type;
+  const char *etag; // Quoted hash of uncompressed content
+};
+
+/*
+ * Sends asset with "Content-Encoding: gzip" or answers 304 if browser cache is actual.
+ * Server must collect "If-None-Match" header by collectHeaders() to make revalidation work.
+ */
+template<class S> void sendWebAsset(S &http, const webasset_t &asset) {
+  String etag = FPSTR(asset.etag);
+
+  http.sendHeader(F("Cache-Control"), F("no-cache")); // Cache, but revalidate by ETag every time
+  http.sendHeader(F("ETag"), etag);
+  if (http.header(F("If-None-Match")).equals(etag)) {
+    http.send(304);
+  } else {
+    http.sendHeader(F("Content-Encoding"), F("gzip"));
+    http.send_P(200, asset.type, (PGM_P)asset.data, asset.size);
+  }
+}
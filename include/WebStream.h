@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Stream.h>
+#ifdef ESP8266
+#include <ESP8266WebServer.h>
+#else
+#include <WebServer.h>
+#endif
+
+/*
+ * Collects HTTP response content into buffer of one TCP segment size
+ * and sends it as a single chunk (with chunked transfer framing) when full or at the end
+ */
+class WebStream : public Stream {
+public:
+#ifdef ESP8266
+  WebStream(ESP8266WebServer &http) : _http(http), _buffer(NULL), _length(0), _chunked(false), _active(false) {}
+#else
+  WebStream(WebServer &http) : _http(http), _buffer(NULL), _length(0), _chunked(false), _active(false) {}
+#endif
+  ~WebStream() {
+    end();
+  }
+
+  bool begin(int code, const char *type); // type is PROGMEM string for ESP8266
+  void end();
+
+  int available() {
+    return 0;
+  }
+  int read() {
+    return -1;
+  }
+  int peek() {
+    return -1;
+  }
+  size_t write(uint8_t data) {
+    return write(&data, sizeof(data));
+  }
+  size_t write(const uint8_t *buffer, size_t size);
+  void flush();
+
+protected:
+#ifdef TCP_MSS
+  static const uint16_t SEGMENT_SIZE = TCP_MSS;
+#else
+  static const uint16_t SEGMENT_SIZE = 1460;
+#endif
+  static const uint8_t HEAD_SIZE = 5; // Up to 3 hex digits of chunk size and CRLF
+  static const uint8_t TAIL_SIZE = 2; // CRLF
+  static const uint16_t BUFFER_SIZE = SEGMENT_SIZE - HEAD_SIZE - TAIL_SIZE; // Whole chunk fits into one segment
+
+  void sendChunk(const uint8_t *data, uint16_t size);
+
+#ifdef ESP8266
+  ESP8266WebServer &_http;
+#else
+  WebServer &_http;
+#endif
+  uint8_t *_buffer; // HEAD_SIZE + BUFFER_SIZE + TAIL_SIZE bytes
+  uint16_t _length;
+  bool _chunked : 1; // Framing is done here, not by web server
+  bool _active : 1;
+};
@@ -0,0 +1,187 @@
+#include "JsonTokenizer.h"
+
+static int8_t hexDigit(char c) {
+  if ((c >= '0') && (c <= '9'))
+    return c - '0';
+  if ((c >= 'A') && (c <= 'F'))
+    return c - 'A' + 10;
+  if ((c >= 'a') && (c <= 'f'))
+    return c - 'a' + 10;
+  return -1;
+}
+
+static bool isDigit(char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+JsonTokenizer::token_t JsonTokenizer::next() {
+  while ((_pos < _length) && ((_json[_pos] == ' ') || (_json[_pos] == '\t') || (_json[_pos] == '\r') || (_json[_pos] == '\n')))
+    ++_pos;
+  _token = &_json[_pos];
+  _tokenLength = 1;
+  if ((_pos >= _length) || (! _json[_pos])) {
+    _tokenLength = 0;
+    return JSON_END;
+  }
+  switch (_json[_pos++]) {
+    case '{':
+      return JSON_BEGIN_OBJECT;
+    case '}':
+      return JSON_END_OBJECT;
+    case '[':
+      return JSON_BEGIN_ARRAY;
+    case ']':
+      return JSON_END_ARRAY;
+    case ':':
+      return JSON_COLON;
+    case ',':
+      return JSON_COMMA;
+    case '"':
+      _token = &_json[_pos];
+      while ((_pos < _length) && (_json[_pos] != '"')) {
+        if ((uint8_t)_json[_pos] < ' ')
+          return JSON_ERROR;
+        if (_json[_pos] == '\\') { // Skip escaped char
+          if (++_pos >= _length)
+            return JSON_ERROR;
+        }
+        ++_pos;
+      }
+      if (_pos >= _length)
+        return JSON_ERROR;
+      _tokenLength = &_json[_pos++] - _token;
+      return JSON_STRING;
+    case 't':
+      return match("rue") ? JSON_TRUE : JSON_ERROR;
+    case 'f':
+      return match("alse") ? JSON_FALSE : JSON_ERROR;
+    case 'n':
+      return match("ull") ? JSON_NULL : JSON_ERROR;
+    default:
+      --_pos;
+      if ((_json[_pos] == '-') || isDigit(_json[_pos])) {
+        if (_json[_pos] == '-')
+          ++_pos;
+        if ((_pos >= _length) || (! isDigit(_json[_pos])))
+          return JSON_ERROR;
+        while ((_pos < _length) && isDigit(_json[_pos]))
+          ++_pos;
+        if ((_pos < _length) && (_json[_pos] == '.')) {
+          if ((++_pos >= _length) || (! isDigit(_json[_pos])))
+            return JSON_ERROR;
+          while ((_pos < _length) && isDigit(_json[_pos]))
+            ++_pos;
+        }
+        if ((_pos < _length) && ((_json[_pos] == 'e') || (_json[_pos] == 'E'))) {
+          if ((++_pos < _length) && ((_json[_pos] == '+') || (_json[_pos] == '-')))
+            ++_pos;
+          if ((_pos >= _length) || (! isDigit(_json[_pos])))
+            return JSON_ERROR;
+          while ((_pos < _length) && isDigit(_json[_pos]))
+            ++_pos;
+        }
+        _tokenLength = &_json[_pos] - _token;
+        return JSON_NUMBER;
+      }
+      return JSON_ERROR;
+  }
+}
+
+bool JsonTokenizer::match(const char *word) {
+  while (*word) {
+    if ((_pos >= _length) || (_json[_pos] != *word))
+      return false;
+    ++_pos;
+    ++word;
+  }
+  _tokenLength = &_json[_pos] - _token;
+  return true;
+}
+
+int16_t JsonTokenizer::unescape(char *buf, uint16_t size) const {
+  uint16_t len = 0;
+
+  for (uint16_t i = 0; i < _tokenLength; ++i) {
+    char c = _token[i];
+
+    if (c == '\\') {
+      switch (_token[++i]) {
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'n':
+          c = '\n';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'u':
+          {
+            uint16_t code = 0;
+
+            if (i + 4 >= _tokenLength)
+              return -1;
+            for (uint8_t j = 0; j < 4; ++j) {
+              int8_t digit = hexDigit(_token[++i]);
+
+              if (digit < 0)
+                return -1;
+              code = (code << 4) | digit;
+            }
+            if (code >= 0x80) { // UTF-8 sequence (surrogate pairs are not combined)
+              uint8_t bytes = code >= 0x800 ? 3 : 2;
+
+              if (len + bytes >= size)
+                return -1;
+              if (bytes == 3) {
+                buf[len++] = 0xE0 | (code >> 12);
+                buf[len++] = 0x80 | ((code >> 6) & 0x3F);
+              } else
+                buf[len++] = 0xC0 | (code >> 6);
+              buf[len++] = 0x80 | (code & 0x3F);
+              continue;
+            }
+            if (! code)
+              return -1;
+            c = code;
+          }
+          break;
+        default: // '"', '\\' and '/'
+          c = _token[i];
+      }
+    }
+    if (len + 1 >= size)
+      return -1;
+    buf[len++] = c;
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+size_t JsonTokenizer::escape(Print &print, const char *str, uint16_t length) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+
+  size_t result = print.write('"');
+
+  while (length--) {
+    char c = *str++;
+
+    if ((c == '"') || (c == '\\')) {
+      result += print.write('\\');
+      result += print.write(c);
+    } else if ((uint8_t)c < ' ') {
+      char code[6] = { '\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F] };
+
+      result += print.write((const uint8_t*)code, sizeof(code));
+    } else
+      result += print.write(c);
+  }
+  result += print.write('"');
+  return result;
+}
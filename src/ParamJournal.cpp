@@ -0,0 +1,206 @@
+#include <string.h>
+#include "ParamJournal.h"
+#include "Parameters.h"
+
+ParamJournal::~ParamJournal() {
+  if (_data)
+    delete[] _data;
+  if (_shadow)
+    delete[] _shadow;
+}
+
+bool ParamJournal::begin(uint16_t size) {
+  if ((_sectors < MIN_SECTORS) || (align(sizeof(sector_t) + sizeof(record_t) + sizeof(segment_t) + size) > SECTOR_SIZE))
+    return false;
+  if (_data && (size != _size)) {
+    delete[] _data;
+    delete[] _shadow;
+    _data = NULL;
+    _shadow = NULL;
+  }
+  if (! _data) {
+    _data = new uint8_t[size];
+    _shadow = new uint8_t[size];
+    if ((! _data) || (! _shadow))
+      return false;
+  }
+  _size = size;
+  memset(_data, 0xFF, _size);
+
+  bool found = false;
+
+  _current = 0;
+  _sequence = 0;
+  for (uint8_t i = 0; i < _sectors; ++i) {
+    sector_t header;
+
+    if (ESP.flashRead(address(i, 0), (uint32_t*)&header, sizeof(header)) && (header.sign == JOURNAL_SIGN)) {
+      if ((! found) || ((int32_t)(header.sequence - _sequence) > 0)) {
+        _current = i;
+        _sequence = header.sequence;
+        found = true;
+      }
+    }
+  }
+  if (found) {
+    if (! replay(_current))
+      _position = SECTOR_SIZE; // Damaged tail, compact at next commit
+  } else {
+    if (_seed && _seed->begin(size)) {
+      memcpy(_data, _seed->getDataPtr(), _size);
+      _seed->end();
+    }
+    _current = _sectors - 1;
+    _position = SECTOR_SIZE; // First commit will write the whole image
+  }
+  memcpy(_shadow, _data, _size);
+  return true;
+}
+
+bool ParamJournal::commit() {
+  if (! _data)
+    return false;
+
+  uint16_t size = 0;
+  uint16_t from, to;
+
+  for (from = 0; from < _size; from = to) { // Size of record payload
+    while ((from < _size) && (_data[from] == _shadow[from]))
+      ++from;
+    if (from >= _size)
+      break;
+    to = from + 1;
+    for (uint16_t i = to; (i < _size) && (i - to < MAX_GAP); ++i) {
+      if (_data[i] != _shadow[i])
+        to = i + 1;
+    }
+    size += sizeof(segment_t) + (to - from);
+  }
+  if (! size) // Nothing changed
+    return true;
+  if (_position + sizeof(record_t) + align(size) > SECTOR_SIZE)
+    return compact();
+
+  uint8_t *record = new uint8_t[sizeof(record_t) + align(size)];
+
+  if (! record)
+    return false;
+
+  uint8_t *ptr = record + sizeof(record_t);
+
+  for (from = 0; from < _size; from = to) {
+    while ((from < _size) && (_data[from] == _shadow[from]))
+      ++from;
+    if (from >= _size)
+      break;
+    to = from + 1;
+    for (uint16_t i = to; (i < _size) && (i - to < MAX_GAP); ++i) {
+      if (_data[i] != _shadow[i])
+        to = i + 1;
+    }
+    ((segment_t*)ptr)->offset = from;
+    ((segment_t*)ptr)->length = to - from;
+    ptr += sizeof(segment_t);
+    memcpy(ptr, &_data[from], to - from);
+    ptr += to - from;
+  }
+  memset(ptr, 0xFF, align(size) - size);
+  ((record_t*)record)->size = size;
+  ((record_t*)record)->crc = Parameters::crc16(record + sizeof(record_t), size);
+
+  bool result = append(record, sizeof(record_t) + align(size));
+
+  delete[] record;
+  if (result)
+    memcpy(_shadow, _data, _size);
+  return result;
+}
+
+bool ParamJournal::replay(uint8_t sector) {
+  uint8_t *payload = NULL;
+  bool result = true;
+
+  _position = sizeof(sector_t);
+  while (_position + sizeof(record_t) <= SECTOR_SIZE) {
+    record_t record;
+
+    if (! ESP.flashRead(address(sector, _position), (uint32_t*)&record, sizeof(record))) {
+      result = false;
+      break;
+    }
+    if (record.size == 0xFFFF) // Erased flash, end of journal
+      break;
+    if ((! record.size) || (_position + sizeof(record_t) + align(record.size) > SECTOR_SIZE)) {
+      result = false;
+      break;
+    }
+    payload = new uint8_t[align(record.size)];
+    if ((! payload) || (! ESP.flashRead(address(sector, _position + sizeof(record_t)), (uint32_t*)payload, align(record.size))) ||
+      (Parameters::crc16(payload, record.size) != record.crc)) { // Interrupted write
+      result = false;
+      break;
+    }
+    for (uint16_t i = 0; i + sizeof(segment_t) <= record.size; ) {
+      const segment_t *segment = (segment_t*)&payload[i];
+
+      i += sizeof(segment_t);
+      if ((segment->offset < _size) && (i + segment->length <= record.size)) {
+        memcpy(&_data[segment->offset], &payload[i], segment->offset + segment->length <= _size ? segment->length : _size - segment->offset);
+      }
+      i += segment->length;
+    }
+    delete[] payload;
+    payload = NULL;
+    _position += sizeof(record_t) + align(record.size);
+  }
+  if (payload)
+    delete[] payload;
+  return result;
+}
+
+bool ParamJournal::append(const uint8_t *record, uint16_t size) {
+  if (! ESP.flashWrite(address(_current, _position), (const uint32_t*)record, size)) {
+    _position = SECTOR_SIZE;
+    return false;
+  }
+  _position += size;
+  return true;
+}
+
+/*
+ * Writes the whole image as the first record of the next sector and then validates the sector by its header,
+ * so the previous sector stays the current one until compaction is completed
+ */
+bool ParamJournal::compact() {
+  uint8_t next = (_current + 1) % _sectors;
+  uint16_t size = sizeof(segment_t) + _size;
+  uint8_t *record = new uint8_t[sizeof(record_t) + align(size)];
+
+  if (! record)
+    return false;
+  ((segment_t*)&record[sizeof(record_t)])->offset = 0;
+  ((segment_t*)&record[sizeof(record_t)])->length = _size;
+  memcpy(&record[sizeof(record_t) + sizeof(segment_t)], _data, _size);
+  memset(&record[sizeof(record_t) + size], 0xFF, align(size) - size);
+  ((record_t*)record)->size = size;
+  ((record_t*)record)->crc = Parameters::crc16(record + sizeof(record_t), size);
+
+  bool result = ESP.flashEraseSector(_sector + next) &&
+    ESP.flashWrite(address(next, sizeof(sector_t)), (const uint32_t*)record, sizeof(record_t) + align(size));
+
+  delete[] record;
+  if (result) {
+    sector_t header;
+
+    header.sign = JOURNAL_SIGN;
+    header.sequence = _sequence + 1;
+    result = ESP.flashWrite(address(next, 0), (const uint32_t*)&header, sizeof(header));
+    if (result) {
+      _current = next;
+      _sequence = header.sequence;
+      _position = sizeof(sector_t) + sizeof(record_t) + align(size);
+      memcpy(_shadow, _data, _size);
+    }
+  }
+  return result;
+}
@@ -0,0 +1,97 @@
+#include <string.h>
+#include "ParamSlots.h"
+#include "Parameters.h"
+
+ParamSlots::~ParamSlots() {
+  if (_data)
+    delete[] _data;
+}
+
+bool ParamSlots::begin(uint16_t size) {
+  if (sizeof(slot_t) + align(size) > SECTOR_SIZE)
+    return false;
+  if (_data && (size != _size)) {
+    delete[] _data;
+    _data = NULL;
+  }
+  if (! _data) {
+    _data = new uint8_t[align(size)];
+    if (! _data)
+      return false;
+  }
+  _size = size;
+
+  slot_t headers[2];
+  bool valid[2];
+
+  for (uint8_t i = 0; i < 2; ++i) {
+    valid[i] = ESP.flashRead(address(i, 0), (uint32_t*)&headers[i], sizeof(slot_t)) && (headers[i].sign == SLOT_SIGN) &&
+      (sizeof(slot_t) + align(headers[i].size) <= SECTOR_SIZE);
+  }
+  uint8_t order[2] = { 0, 1 };
+
+  if (valid[0] && valid[1] && ((int32_t)(headers[1].generation - headers[0].generation) > 0)) { // Newest first
+    order[0] = 1;
+    order[1] = 0;
+  }
+  _active = 1;
+  _generation = 0;
+  for (uint8_t n = 0; n < 2; ++n) {
+    uint8_t i = order[n];
+
+    if (valid[i]) {
+      memset(_data, 0xFF, align(_size));
+      if (load(i, headers[i])) {
+        _active = i;
+        _generation = headers[i].generation;
+        return true;
+      }
+    }
+  }
+  memset(_data, 0xFF, align(_size));
+  if (_seed && _seed->begin(size)) {
+    memcpy(_data, _seed->getDataPtr(), _size);
+    _seed->end();
+  }
+  return true;
+}
+
+bool ParamSlots::commit() {
+  if (! _data)
+    return false;
+
+  uint8_t inactive = _active ^ 1;
+  slot_t header;
+
+  memset(&_data[_size], 0xFF, align(_size) - _size);
+  header.sign = SLOT_SIGN;
+  header.generation = _generation + 1;
+  header.size = _size;
+  header.crc = Parameters::crc16(_data, _size);
+  if (ESP.flashEraseSector(_sector + inactive) &&
+    ESP.flashWrite(address(inactive, sizeof(slot_t)), (const uint32_t*)_data, align(_size)) &&
+    ESP.flashWrite(address(inactive, 0), (const uint32_t*)&header, sizeof(slot_t))) {
+    _active = inactive;
+    _generation = header.generation;
+    return true;
+  }
+  return false;
+}
+
+bool ParamSlots::load(uint8_t slot, const slot_t &header) {
+  uint32_t buffer[8];
+  uint16_t crc = 0xFFFF;
+
+  for (uint16_t offset = 0; offset < header.size; offset += sizeof(buffer)) {
+    uint16_t len = header.size - offset;
+
+    if (len > sizeof(buffer))
+      len = sizeof(buffer);
+    if (! ESP.flashRead(address(slot, sizeof(slot_t) + offset), buffer, align(len)))
+      return false;
+    crc = Parameters::crc16((uint8_t*)buffer, len, crc);
+    if (offset < _size)
+      memcpy(&_data[offset], buffer, offset + len <= _size ? len : _size - offset);
+  }
+  return crc == header.crc;
+}
@@ -0,0 +1,123 @@
+#include <EEPROM.h>
+#include "ParamStorage.h"
+
+bool EEPROMStorage::begin(uint16_t size) {
+#ifdef ESP8266
+  EEPROM.begin(size);
+  return true;
+#else
+  return EEPROM.begin(size);
+#endif
+}
+
+void EEPROMStorage::end() {
+  EEPROM.end();
+}
+
+uint8_t *EEPROMStorage::getDataPtr() {
+  return EEPROM.getDataPtr();
+}
+
+bool EEPROMStorage::commit() {
+  return EEPROM.commit();
+}
+
+RAMStorage::~RAMStorage() {
+  end();
+  if (_image)
+    delete[] _image;
+}
+
+bool RAMStorage::begin(uint16_t size) {
+  if (_data && (size != _size))
+    end();
+  if (! _data) {
+    _data = new uint8_t[size];
+    if (! _data)
+      return false;
+  }
+  _size = size;
+  memset(_data, 0xFF, _size);
+  if (_image)
+    memcpy(_data, _image, _imageSize < _size ? _imageSize : _size);
+  return true;
+}
+
+void RAMStorage::end() {
+  if (_data) {
+    delete[] _data;
+    _data = NULL;
+  }
+}
+
+uint8_t *RAMStorage::getDataPtr() {
+  return _data;
+}
+
+bool RAMStorage::commit() {
+  if (! _data)
+    return false;
+  if (_image && (_imageSize != _size)) {
+    delete[] _image;
+    _image = NULL;
+  }
+  if (! _image) {
+    _image = new uint8_t[_size];
+    if (! _image)
+      return false;
+    _imageSize = _size;
+  }
+  memcpy(_image, _data, _size);
+  ++_commits;
+  return true;
+}
+
+FileStorage::~FileStorage() {
+  end();
+}
+
+bool FileStorage::begin(uint16_t size) {
+  if (_data && (size != _size))
+    end();
+  if (! _data) {
+    _data = new uint8_t[size];
+    if (! _data)
+      return false;
+  }
+  _size = size;
+  memset(_data, 0xFF, _size);
+
+  File file = _fs.open(_path, "r");
+
+  if (file) {
+    file.read(_data, _size);
+    file.close();
+  }
+  return true;
+}
+
+void FileStorage::end() {
+  if (_data) {
+    delete[] _data;
+    _data = NULL;
+  }
+}
+
+uint8_t *FileStorage::getDataPtr() {
+  return _data;
+}
+
+bool FileStorage::commit() {
+  if (! _data)
+    return false;
+
+  File file = _fs.open(_path, "w");
+
+  if (! file)
+    return false;
+
+  bool result = file.write(_data, _size) == _size;
+
+  file.close();
+  return result;
+}
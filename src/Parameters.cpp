@@ -3,7 +3,6 @@
 #ifdef ESP32
 #include <esp_log.h>
 #endif
-#include <EEPROM.h>
 #ifdef ESP8266
 #include <ESP8266WiFi.h>
 #else
@@ -12,10 +11,11 @@
 #include <DNSServer.h>
 #include <StreamString.h>
 #include "Parameters.h"
-#ifdef ESP8266
 #include "StrUtils.h"
-#endif
 #include "SimpleBase64.h"
+#include "JsonTokenizer.h"
+#include "WebAsset.h"
+#include "WebStream.h"
 
 #ifdef ESP32
 static const char TAG[] = "Parameters";
@@ -24,96 +24,237 @@ static const char TAG[] = "Parameters";
 #ifdef ESP8266
 static const char EMPTY_PSTR[] PROGMEM = "";
 
-static const char FMT_I8_PSTR[] PROGMEM = "%hhd";
-static const char FMT_U8_PSTR[] PROGMEM = "%hhu";
-static const char FMT_I16_PSTR[] PROGMEM = "%hd";
-static const char FMT_U16_PSTR[] PROGMEM = "%hu";
-static const char FMT_I32_PSTR[] PROGMEM = "%d";
-static const char FMT_U32_PSTR[] PROGMEM = "%u";
-static const char FMT_FLOAT_PSTR[] PROGMEM = "%f";
-static const char FMT_IP_PSTR[] PROGMEM = "%hhu.%hhu.%hhu.%hhu";
-
 static const char QUOT_PSTR[] PROGMEM = "&quot;";
 static const char LT_PSTR[] PROGMEM = "&lt;";
 static const char GT_PSTR[] PROGMEM = "&gt;";
 
 static const char TEXTHTML_PSTR[] PROGMEM = "text/html";
 static const char TEXTPLAIN_PSTR[] PROGMEM = "text/plain";
+static const char APPJSON_PSTR[] PROGMEM = "application/json";
 #else
 static const char EMPTY_PSTR[] = "";
 
-static const char FMT_I8_PSTR[] = "%hhd";
-static const char FMT_U8_PSTR[] = "%hhu";
-static const char FMT_I16_PSTR[] = "%hd";
-static const char FMT_U16_PSTR[] = "%hu";
-static const char FMT_I32_PSTR[] = "%d";
-static const char FMT_U32_PSTR[] = "%u";
-static const char FMT_FLOAT_PSTR[] = "%f";
-static const char FMT_IP_PSTR[] = "%hhu.%hhu.%hhu.%hhu";
-
 static const char QUOT_PSTR[] = "&quot;";
 static const char LT_PSTR[] = "&lt;";
 static const char GT_PSTR[] = "&gt;";
 
 static const char TEXTHTML_PSTR[] = "text/html";
 static const char TEXTPLAIN_PSTR[] = "text/plain";
+static const char APPJSON_PSTR[] = "application/json";
+#endif
+
+// Editor helpers of web/params.js inlined into the page when application passes no script asset
+#ifdef ESP8266
+static const char SCRIPT_PSTR[] PROGMEM =
+#else
+static const char SCRIPT_PSTR[] =
 #endif
+  "<script type=\"text/javascript\">\n"
+  "function getXmlHttpRequest(){\n"
+  "let x;\n"
+  "try{\n"
+  "x=new ActiveXObject(\"Msxml2.XMLHTTP\");\n"
+  "}catch(e){\n"
+  "try{\n"
+  "x=newActiveXObject(\"Microsoft.XMLHTTP\");\n"
+  "}catch(E){\n"
+  "x=false;\n"
+  "}\n"
+  "}\n"
+  "if((!x)&&(typeof XMLHttpRequest!='undefined')){\n"
+  "x=new XMLHttpRequest();\n"
+  "}\n"
+  "return x;\n"
+  "}\n"
+  "function openUrl(u,m){\n"
+  "let x=getXmlHttpRequest();\n"
+  "x.open(m,u,false);\n"
+  "x.send(null);\n"
+  "if(x.status!=200){\n"
+  "alert(x.responseText);\n"
+  "return false;\n"
+  "}\n"
+  "return true;\n"
+  "}\n"
+  "function checkInt(e,d,m,x){\n"
+  "let n=parseInt(e.value);\n"
+  "if(isNaN(n)){\n"
+  "n=d;\n"
+  "}else{\n"
+  "if(n<m)n=m;\n"
+  "if(n>x)n=x;\n"
+  "}\n"
+  "e.value=n.toString();\n"
+  "}\n"
+  "function checkFloat(e,d,m,x){\n"
+  "let n=parseFloat(e.value);\n"
+  "if(isNaN(n)){\n"
+  "n=d;\n"
+  "}else{\n"
+  "if((!isNaN(m))&&(n<m))n=m;\n"
+  "if((!isNaN(x))&&(n>x))n=x;\n"
+  "}\n"
+  "if(isNaN(n)){e.value=\"\";\n"
+  "}else{\n"
+  "e.value=n.toString();\n"
+  "}\n"
+  "}\n"
+  "function processTab(t,e){\n"
+  "if(e.which==9){\n"
+  "let start=t.selectionStart;\n"
+  "let end=t.selectionEnd;\n"
+  "t.value=t.value.substr(0,start)+'\t'+t.value.substr(end);\n"
+  "t.selectionStart=t.selectionEnd=start+1;\n"
+  "e.preventDefault();\n"
+  "return false;\n"
+  "}\n"
+  "}\n"
+  "</script>\n";
+
+static EEPROMStorage eepromStorage;
+
+Parameters::Parameters(const paraminfo_t *params, uint16_t cnt, ParamStorage *storage) : _params((const uint8_t*)params), _editorIndex(NULL),
+  _editorLists(NULL), _editorData(NULL), _offsets(NULL), _sorted(NULL), _txData(NULL), _commitQuiet(0), _commitLatency(0), _pending(false),
+  _observers(NULL), _snapshot(NULL), _ownLayout(false), _stride(sizeof(paraminfo_t)), _count(cnt), _inited(false) {
+  _storage = storage ? storage : &eepromStorage;
+}
+
+Parameters::~Parameters() {
+  if (_ownLayout) {
+    delete[] _offsets;
+    delete[] _sorted;
+  }
+  if (_txData)
+    delete[] _txData;
+  while (_observers) {
+    observer_t *next = _observers->next;
+
+    delete _observers;
+    _observers = next;
+  }
+  if (_snapshot)
+    delete[] _snapshot;
+}
 
 bool Parameters::begin() {
   if (! _inited) {
-    uint16_t size = sizeof(header_t);
+    dirent_t *dir = new dirent_t[_count];
 
+    if (! dir) {
+#ifdef ESP32
+      ESP_LOGE(TAG, "Error allocating of parameters directory!");
+#endif
+      return false;
+    }
     for (uint16_t i = 0; i < _count; ++i) {
-#ifdef ESP8266
-      size += pgm_read_word(&_params[i].size);
-#else
-      size += _params[i].size;
+      dir[i].tag = nameTag(i);
+      dir[i].type = type(i);
+      dir[i].size = size(i);
+    }
+    if (! _offsets) { // Not built at compile time by paramLayout()
+      uint16_t *offsets = new uint16_t[_count];
+      uint16_t *sorted = new uint16_t[_count];
+
+      if ((! offsets) || (! sorted)) {
+#ifdef ESP32
+        ESP_LOGE(TAG, "Error allocating of parameters layout!");
 #endif
+        if (offsets)
+          delete[] offsets;
+        if (sorted)
+          delete[] sorted;
+        delete[] dir;
+        return false;
+      }
+      for (uint16_t i = 0; i < _count; ++i) {
+        uint16_t j = i;
+
+        while (j && (compareName(sorted[j - 1], name(i)) > 0)) {
+          sorted[j] = sorted[j - 1];
+          --j;
+        }
+        sorted[j] = i;
+      }
+      _dataSize = layout(dir, _count, offsets, _bitsOffset);
+      _offsets = offsets;
+      _sorted = sorted;
+      _ownLayout = true;
     }
-#ifdef ESP8266
-    EEPROM.begin(size);
-    _inited = true;
-#else
-    _inited = EEPROM.begin(size);
+    _dataOffset = dataOffset(_count);
+    _schema = crc16((uint8_t*)dir, _count * sizeof(dirent_t));
+
+    uint16_t size = _dataOffset + _dataSize;
+
+    clearDirty();
+
+    _inited = _storage->begin(size);
     if (! _inited) {
-      ESP_LOGE(TAG, "Error allocating of EEPROM (%hu bytes)!", size);
-      return false;
-    }
+#ifdef ESP32
+      ESP_LOGE(TAG, "Error allocating of storage (%hu bytes)!", size);
+#endif
+    } else if (! check()) {
+      if (migrate(dir)) {
+#ifdef ESP32
+        ESP_LOGI(TAG, "EEPROM parameters migrated to current schema");
 #endif
-    if (! check()) {
-      clear();
+      } else {
+        writeDirectory(dir);
+        clear();
+        flush();
 #ifdef ESP32
-      ESP_LOGW(TAG, "Reset EEPROM parameters!");
+        ESP_LOGW(TAG, "Reset EEPROM parameters!");
 #endif
+      }
     }
+    delete[] dir;
+    if (_inited && _observers)
+      takeSnapshot();
   }
   return _inited;
 }
 
 int16_t Parameters::find(const char *name) const {
-  for (uint16_t i = 0; i < _count; ++i) {
-#ifdef ESP8266
-    if (! strcmp_PP((char*)pgm_read_ptr(&_params[i].name), name))
-#else
-    if (! strcmp(_params[i].name, name))
-#endif
-      return i;
+  if (_sorted) {
+    uint16_t left = 0, right = _count;
+
+    while (left < right) {
+      uint16_t middle = (left + right) / 2;
+      int8_t cmp = compareName(_sorted[middle], name);
+
+      if (! cmp)
+        return _sorted[middle];
+      if (cmp < 0)
+        left = middle + 1;
+      else
+        right = middle;
+    }
+  } else {
+    for (uint16_t i = 0; i < _count; ++i) {
+      if (! compareName(i, name))
+        return i;
+    }
   }
   return -1;
 }
 
-const paraminfo_t *Parameters::getInfo(uint16_t index) const {
-  if (index < _count)
-    return &_params[index];
-  return NULL;
+bool Parameters::getInfo(uint16_t index, paraminfo_t &info) const {
+  if (index >= _count)
+    return false;
+#ifdef ESP8266
+  memcpy_P(&info, desc(index), sizeof(paramdesc_t));
+#else
+  memcpy(&info, desc(index), sizeof(paramdesc_t));
+#endif
+  getEditor(index, info.editor);
+  return true;
 }
 
 const char *Parameters::name(uint16_t index) const {
   if (index < _count)
 #ifdef ESP8266
-    return (char*)pgm_read_ptr(&_params[index].name);
+    return (char*)pgm_read_ptr(&desc(index)->name);
 #else
-    return _params[index].name;
+    return desc(index)->name;
 #endif
   return NULL;
 }
@@ -121,42 +262,32 @@ const char *Parameters::name(uint16_t index) const {
 paraminfo_t::paramtype_t Parameters::type(uint16_t index) const {
   if (index < _count)
 #ifdef ESP8266
-    return (paraminfo_t::paramtype_t)pgm_read_byte(&_params[index].type);
+    return (paraminfo_t::paramtype_t)pgm_read_byte(&desc(index)->type);
 #else
-    return _params[index].type;
+    return desc(index)->type;
 #endif
 }
 
 uint16_t Parameters::size(uint16_t index) const {
   if (index < _count)
 #ifdef ESP8266
-    return pgm_read_word(&_params[index].size);
+    return pgm_read_word(&desc(index)->size);
 #else
-    return _params[index].size;
+    return desc(index)->size;
 #endif
   return 0;
 }
 
-#ifdef ESP8266
 const void *Parameters::value(uint16_t index) const {
-  const void *result = NULL;
+  static const bool BOOL_VALUES[2] = { false, true };
 
   if (_inited && (index < _count)) {
-    result = getPtr(index);
-
-    if (result) {
-      paraminfo_t::paramtype_t type = (paraminfo_t::paramtype_t)pgm_read_byte(&_params[index].type);
-      uint16_t size = pgm_read_word(&_params[index].size);
-
-      if ((size > 1) && ((type != paraminfo_t::PARAM_STR) && (type != paraminfo_t::PARAM_BINARY))) {
-        memcpy((void*)_alignedData, result, size);
-        result = _alignedData;
-      }
-    }
+    if (type(index) == paraminfo_t::PARAM_BOOL)
+      return &BOOL_VALUES[getBit(index)];
+    return getPtr(index);
   }
-  return result;
+  return NULL;
 }
-#endif
 
 bool Parameters::clear() {
   for (uint16_t i = 0; i < _count; ++i) {
@@ -168,9 +299,9 @@ bool Parameters::clear() {
 void Parameters::clear(uint16_t index) {
   if (_inited && (index < _count)) {
 #ifdef ESP8266
-    switch (pgm_read_byte(&_params[index].type)) {
+    switch (pgm_read_byte(&desc(index)->type)) {
 #else
-    switch (_params[index].type) {
+    switch (desc(index)->type) {
 #endif
       case paraminfo_t::PARAM_BOOL:
       case paraminfo_t::PARAM_U8:
@@ -179,14 +310,14 @@ void Parameters::clear(uint16_t index) {
       case paraminfo_t::PARAM_U32:
       case paraminfo_t::PARAM_FLOAT:
       case paraminfo_t::PARAM_CHAR:
-        set(index, &_params[index].defvalue);
+        set(index, &desc(index)->defvalue);
         break;
       case paraminfo_t::PARAM_I8:
         {
 #ifdef ESP8266
-          int8_t i8 = (int32_t)pgm_read_dword(&_params[index].defvalue.asint);
+          int8_t i8 = (int32_t)pgm_read_dword(&desc(index)->defvalue.asint);
 #else
-          int8_t i8 = _params[index].defvalue.asint;
+          int8_t i8 = desc(index)->defvalue.asint;
 #endif
 
           set(index, &i8);
@@ -195,9 +326,9 @@ void Parameters::clear(uint16_t index) {
       case paraminfo_t::PARAM_I16:
         {
 #ifdef ESP8266
-          int16_t i16 = (int32_t)pgm_read_dword(&_params[index].defvalue.asint);
+          int16_t i16 = (int32_t)pgm_read_dword(&desc(index)->defvalue.asint);
 #else
-          int16_t i16 = _params[index].defvalue.asint;
+          int16_t i16 = desc(index)->defvalue.asint;
 #endif
 
           set(index, &i16);
@@ -205,23 +336,23 @@ void Parameters::clear(uint16_t index) {
         break;
       case paraminfo_t::PARAM_STR:
 #ifdef ESP8266
-        set(index, pgm_read_ptr(&_params[index].defvalue.asstr));
+        set(index, pgm_read_ptr(&desc(index)->defvalue.asstr));
 #else
-        set(index, _params[index].defvalue.asstr);
+        set(index, desc(index)->defvalue.asstr);
 #endif
         break;
       case paraminfo_t::PARAM_BINARY:
 #ifdef ESP8266
-        set(index, pgm_read_ptr(&_params[index].defvalue.asbinary));
+        set(index, pgm_read_ptr(&desc(index)->defvalue.asbinary));
 #else
-        set(index, _params[index].defvalue.asbinary);
+        set(index, desc(index)->defvalue.asbinary);
 #endif
         break;
       case paraminfo_t::PARAM_IP:
 #ifdef ESP8266
-        set(index, &_params[index].defvalue.asip[0]);
+        set(index, &desc(index)->defvalue.asip[0]);
 #else
-        set(index, _params[index].defvalue.asip);
+        set(index, desc(index)->defvalue.asip);
 #endif
         break;
     }
@@ -234,16 +365,22 @@ bool Parameters::get(uint16_t index, void *data, uint16_t maxsize) {
 
     if (ptr) {
 #ifdef ESP8266
-      paraminfo_t::paramtype_t type = (paraminfo_t::paramtype_t)pgm_read_byte(&_params[index].type);
-      uint16_t size = pgm_read_word(&_params[index].size);
+      paraminfo_t::paramtype_t type = (paraminfo_t::paramtype_t)pgm_read_byte(&desc(index)->type);
+      uint16_t size = pgm_read_word(&desc(index)->size);
 
-      if ((type < paraminfo_t::PARAM_STR) || (type == paraminfo_t::PARAM_IP)) {
+      if (type == paraminfo_t::PARAM_BOOL) {
+        *(bool*)data = getBit(index);
+        return true;
+      } else if ((type < paraminfo_t::PARAM_STR) || (type == paraminfo_t::PARAM_IP)) {
         if (maxsize >= size) {
           memcpy(data, ptr, size);
 #else
-      if ((_params[index].type < paraminfo_t::PARAM_STR) || (_params[index].type == paraminfo_t::PARAM_IP)) {
-        if (maxsize >= _params[index].size) {
-          memcpy(data, ptr, _params[index].size);
+      if (desc(index)->type == paraminfo_t::PARAM_BOOL) {
+        *(bool*)data = getBit(index);
+        return true;
+      } else if ((desc(index)->type < paraminfo_t::PARAM_STR) || (desc(index)->type == paraminfo_t::PARAM_IP)) {
+        if (maxsize >= desc(index)->size) {
+          memcpy(data, ptr, desc(index)->size);
 #endif
           return true;
         }
@@ -253,9 +390,9 @@ bool Parameters::get(uint16_t index, void *data, uint16_t maxsize) {
           maxsize = size;
         if (type == paraminfo_t::PARAM_STR) {
 #else
-        if (maxsize > _params[index].size)
-          maxsize = _params[index].size;
-        if (_params[index].type == paraminfo_t::PARAM_STR) {
+        if (maxsize > desc(index)->size)
+          maxsize = desc(index)->size;
+        if (desc(index)->type == paraminfo_t::PARAM_STR) {
 #endif
           memcpy(data, ptr, maxsize - 1);
           ((char*)data)[maxsize - 1] = '\0';
@@ -275,28 +412,37 @@ bool Parameters::set(uint16_t index, const void *data) {
 
     if (ptr) {
 #ifdef ESP8266
-      uint16_t size = pgm_read_word(&_params[index].size);
+      uint16_t size = pgm_read_word(&desc(index)->size);
 
+      if (pgm_read_byte(&desc(index)->type) == paraminfo_t::PARAM_BOOL) {
+        setBit(index, data && pgm_read_byte(data));
+        return true;
+      }
       memset(ptr, 0, size);
 #else
-      memset(ptr, 0, _params[index].size);
+      if (desc(index)->type == paraminfo_t::PARAM_BOOL) {
+        setBit(index, data && *(bool*)data);
+        return true;
+      }
+      memset(ptr, 0, desc(index)->size);
 #endif
       if (data) {
 #ifdef ESP8266
-        if (pgm_read_byte(&_params[index].type) != paraminfo_t::PARAM_STR) {
+        if (pgm_read_byte(&desc(index)->type) != paraminfo_t::PARAM_STR) {
           memcpy_P(ptr, data, size);
         } else { // type == PARAM_STR
           strncpy_P((char*)ptr, (char*)data, size - 1);
 //          ((char*)ptr)[size - 1] = '\0';
 #else
-        if (_params[index].type != paraminfo_t::PARAM_STR) {
-          memcpy(ptr, data, _params[index].size);
+        if (desc(index)->type != paraminfo_t::PARAM_STR) {
+          memcpy(ptr, data, desc(index)->size);
         } else { // type == PARAM_STR
-          strncpy((char*)ptr, (char*)data, _params[index].size - 1);
-//          ((char*)ptr)[_params[index].size - 1] = '\0';
+          strncpy((char*)ptr, (char*)data, desc(index)->size - 1);
+//          ((char*)ptr)[desc(index)->size - 1] = '\0';
 #endif
         }
       }
+      markDirty(index);
       return true;
     }
   }
@@ -313,410 +459,391 @@ String Parameters::toString(uint16_t index, bool encode) {
   return String();
 }
 
-#ifdef ESP8266
 int16_t Parameters::toStream(uint16_t index, Stream &stream, bool encode) {
   int16_t result = -1;
 
   if (_inited && (index < _count)) {
-    const void *ptr = value(index);
+    if (type(index) == paraminfo_t::PARAM_BINARY) {
+      const void *ptr = value(index);
 
-    if (ptr) {
-      switch (pgm_read_byte(&_params[index].type)) {
-        case paraminfo_t::PARAM_BOOL:
-          if (*(bool*)ptr)
-            result = stream.print(FPSTR((char*)pgm_read_ptr(&BOOLS[true])));
-          else
-            result = stream.print(FPSTR((char*)pgm_read_ptr(&BOOLS[false])));
-          break;
-        case paraminfo_t::PARAM_I8:
-          result = stream.printf_P(FMT_I8_PSTR, *(int8_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U8:
-          result = stream.printf_P(FMT_U8_PSTR, *(uint8_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_I16:
-          result = stream.printf_P(FMT_I16_PSTR, *(int16_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U16:
-          result = stream.printf_P(FMT_U16_PSTR, *(uint16_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_I32:
-          result = stream.printf_P(FMT_I32_PSTR, *(int32_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U32:
-          result = stream.printf_P(FMT_U32_PSTR, *(uint32_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_FLOAT:
-          result = stream.printf_P(FMT_FLOAT_PSTR, *(float*)ptr);
-          break;
-        case paraminfo_t::PARAM_CHAR:
-          if (encode)
-            result = stream.print(encodeString(*(char*)ptr));
-          else
-            result = stream.print(*(char*)ptr);
-          break;
-        case paraminfo_t::PARAM_STR:
-          if (encode)
-            result = stream.print(encodeString((char*)ptr));
-          else
-            result = stream.print((char*)ptr);
-          break;
-        case paraminfo_t::PARAM_BINARY:
-          result = encodeBase64(stream, (uint8_t*)ptr, pgm_read_word(&_params[index].size));
-          break;
-        case paraminfo_t::PARAM_IP:
-          result = stream.printf_P(FMT_IP_PSTR, (*(paraminfo_t::ipaddr_t*)ptr)[0], (*(paraminfo_t::ipaddr_t*)ptr)[1],
-            (*(paraminfo_t::ipaddr_t*)ptr)[2], (*(paraminfo_t::ipaddr_t*)ptr)[3]);
-          break;
+      if (ptr)
+        result = encodeBase64(stream, (uint8_t*)ptr, size(index));
+    } else {
+      char buf[FORMAT_SIZE];
+      const char *str = format(index, buf);
+
+      if (str) {
+        if (encode)
+          result = encodeString(stream, str);
+        else
+          result = stream.write((const uint8_t*)str, strlen(str));
       }
     }
   }
   return result;
 }
 
-#else
-int16_t Parameters::toStream(uint16_t index, Stream &stream, bool encode) {
-  int16_t result = -1;
-
-  if (_inited && (index < _count)) {
-    const void *ptr = getPtr(index);
+const char *Parameters::format(uint16_t index, char *buf) const {
+  const void *ptr = value(index);
 
-    if (ptr) {
-      switch (_params[index].type) {
-        case paraminfo_t::PARAM_BOOL:
-          if (*(bool*)ptr)
-            result = stream.print(BOOLS[true]);
-          else
-            result = stream.print(BOOLS[false]);
-          break;
-        case paraminfo_t::PARAM_I8:
-          result = stream.printf(FMT_I8_PSTR, *(int8_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U8:
-          result = stream.printf(FMT_U8_PSTR, *(uint8_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_I16:
-          result = stream.printf(FMT_I16_PSTR, *(int16_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U16:
-          result = stream.printf(FMT_U16_PSTR, *(uint16_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_I32:
-          result = stream.printf(FMT_I32_PSTR, *(int32_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_U32:
-          result = stream.printf(FMT_U32_PSTR, *(uint32_t*)ptr);
-          break;
-        case paraminfo_t::PARAM_FLOAT:
-          result = stream.printf(FMT_FLOAT_PSTR, *(float*)ptr);
-          break;
-        case paraminfo_t::PARAM_CHAR:
-          if (encode)
-            result = stream.print(encodeString(*(char*)ptr));
-          else
-            result = stream.print(*(char*)ptr);
-          break;
-        case paraminfo_t::PARAM_STR:
-          if (encode)
-            result = stream.print(encodeString((char*)ptr));
-          else
-            result = stream.print((char*)ptr);
-          break;
-        case paraminfo_t::PARAM_BINARY:
-          result = encodeBase64(stream, (uint8_t*)ptr, _params[index].size);
-          break;
-        case paraminfo_t::PARAM_IP:
-          result = stream.printf(FMT_IP_PSTR, (*(paraminfo_t::ipaddr_t*)ptr)[0], (*(paraminfo_t::ipaddr_t*)ptr)[1],
-            (*(paraminfo_t::ipaddr_t*)ptr)[2], (*(paraminfo_t::ipaddr_t*)ptr)[3]);
-          break;
-      }
-    }
+  if (! ptr)
+    return NULL;
+  switch (type(index)) {
+    case paraminfo_t::PARAM_BOOL:
+#ifdef ESP8266
+      strcpy_P(buf, (char*)pgm_read_ptr(&BOOLS[*(bool*)ptr]));
+#else
+      strcpy(buf, BOOLS[*(bool*)ptr]);
+#endif
+      break;
+    case paraminfo_t::PARAM_I8:
+      formatInt(buf, *(int8_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_U8:
+      formatUInt(buf, *(uint8_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_I16:
+      formatInt(buf, *(int16_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_U16:
+      formatUInt(buf, *(uint16_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_I32:
+      formatInt(buf, *(int32_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_U32:
+      formatUInt(buf, *(uint32_t*)ptr);
+      break;
+    case paraminfo_t::PARAM_FLOAT:
+      formatFloat(buf, *(float*)ptr);
+      break;
+    case paraminfo_t::PARAM_CHAR:
+      buf[0] = *(char*)ptr;
+      buf[1] = '\0';
+      break;
+    case paraminfo_t::PARAM_STR:
+      return (const char*)ptr;
+    case paraminfo_t::PARAM_IP:
+      formatIP(buf, (uint8_t*)ptr);
+      break;
+    default: // PARAM_BINARY has no short text form
+      return NULL;
   }
-  return result;
+  return buf;
 }
-#endif
 
 #ifdef ESP8266
-bool Parameters::fromString(uint16_t index, const String &str) {
+bool Parameters::parse(uint16_t index, const char *str) {
   bool result = false;
 
   if (_inited && (index < _count)) {
     void *ptr = getPtr(index);
 
     if (ptr) {
-      uint8_t data[4];
+      int32_t i32;
+      uint32_t u32;
 
-      switch (pgm_read_byte(&_params[index].type)) {
+      switch (pgm_read_byte(&desc(index)->type)) {
         case paraminfo_t::PARAM_BOOL:
-          if (str.equals(FPSTR((char*)pgm_read_ptr(&BOOLS[true]))) || str.equals(F("1"))) {
-            *(bool*)ptr = true;
+          if ((! strcmp_P(str, (char*)pgm_read_ptr(&BOOLS[true]))) || (! strcmp_P(str, PSTR("1")))) {
+            setBit(index, true);
             result = true;
-          } else if (str.equals(FPSTR((char*)pgm_read_ptr(&BOOLS[false]))) || str.equals(F("0"))) {
-            *(bool*)ptr = false;
+          } else if ((! strcmp_P(str, (char*)pgm_read_ptr(&BOOLS[false]))) || (! strcmp_P(str, PSTR("0")))) {
+            setBit(index, false);
             result = true;
           }
           break;
         case paraminfo_t::PARAM_I8:
-          result = sscanf_P(str.c_str(), FMT_I8_PSTR, (int8_t*)ptr) == 1;
+          result = parseInt(str, i32, INT8_MIN, INT8_MAX);
+          if (result)
+            *(int8_t*)ptr = i32;
           break;
         case paraminfo_t::PARAM_U8:
-          result = sscanf_P(str.c_str(), FMT_U8_PSTR, (uint8_t*)ptr) == 1;
+          result = parseUInt(str, u32, UINT8_MAX);
+          if (result)
+            *(uint8_t*)ptr = u32;
           break;
         case paraminfo_t::PARAM_I16:
-          result = sscanf_P(str.c_str(), FMT_I16_PSTR, (int16_t*)data) == 1;
+          result = parseInt(str, i32, INT16_MIN, INT16_MAX);
           if (result)
-            set(index, data);
+            *(int16_t*)ptr = i32;
           break;
         case paraminfo_t::PARAM_U16:
-          result = sscanf_P(str.c_str(), FMT_U16_PSTR, (uint16_t*)data) == 1;
+          result = parseUInt(str, u32, UINT16_MAX);
           if (result)
-            set(index, data);
+            *(uint16_t*)ptr = u32;
           break;
         case paraminfo_t::PARAM_I32:
-          result = sscanf_P(str.c_str(), FMT_I32_PSTR, (int32_t*)data) == 1;
-          if (result)
-            set(index, data);
+          result = parseInt(str, *(int32_t*)ptr);
           break;
         case paraminfo_t::PARAM_U32:
-          result = sscanf_P(str.c_str(), FMT_U32_PSTR, (uint32_t*)data) == 1;
-          if (result)
-            set(index, data);
+          result = parseUInt(str, *(uint32_t*)ptr);
           break;
         case paraminfo_t::PARAM_FLOAT:
-          result = sscanf_P(str.c_str(), FMT_FLOAT_PSTR, (float*)data) == 1;
-          if (result)
-            set(index, data);
+          result = parseFloat(str, *(float*)ptr);
           break;
         case paraminfo_t::PARAM_CHAR:
           *(char*)ptr = str[0];
           result = true;
           break;
         case paraminfo_t::PARAM_STR:
-          strncpy((char*)ptr, str.c_str(), pgm_read_word(&_params[index].size) - 1);
-          ((char*)ptr)[pgm_read_word(&_params[index].size) - 1] = '\0';
+          strncpy((char*)ptr, str, pgm_read_word(&desc(index)->size) - 1);
+          ((char*)ptr)[pgm_read_word(&desc(index)->size) - 1] = '\0';
           result = true;
           break;
         case paraminfo_t::PARAM_BINARY:
-          result = decodeBase64(str.c_str(), (uint8_t*)ptr, pgm_read_word(&_params[index].size)) != -1;
+          result = decodeBase64(str, (uint8_t*)ptr, pgm_read_word(&desc(index)->size)) != -1;
           break;
         case paraminfo_t::PARAM_IP:
-          result = sscanf_P(str.c_str(), FMT_IP_PSTR, &data[0], &data[1], &data[2], &data[3]);
-          if (result)
-            set(index, data);
+          result = parseIP(str, (uint8_t*)ptr);
           break;
       }
-      if (! result) {
-        clear(index);
-      }
+      result = complete(index, result);
     }
   }
   return result;
 }
 
 #else
-bool Parameters::fromString(uint16_t index, const String &str) {
+bool Parameters::parse(uint16_t index, const char *str) {
   bool result = false;
 
   if (_inited && (index < _count)) {
     void *ptr = getPtr(index);
 
     if (ptr) {
-      switch (_params[index].type) {
+      int32_t i32;
+      uint32_t u32;
+
+      switch (desc(index)->type) {
         case paraminfo_t::PARAM_BOOL:
-          if (str.equals(BOOLS[true]) || str.equals("1")) {
-            *(bool*)ptr = true;
+          if ((! strcmp(str, BOOLS[true])) || (! strcmp(str, "1"))) {
+            setBit(index, true);
             result = true;
-          } else if (str.equals(BOOLS[false]) || str.equals("0")) {
-            *(bool*)ptr = false;
+          } else if ((! strcmp(str, BOOLS[false])) || (! strcmp(str, "0"))) {
+            setBit(index, false);
             result = true;
           }
           break;
         case paraminfo_t::PARAM_I8:
-          result = sscanf(str.c_str(), FMT_I8_PSTR, (int8_t*)ptr) == 1;
+          result = parseInt(str, i32, INT8_MIN, INT8_MAX);
+          if (result)
+            *(int8_t*)ptr = i32;
           break;
         case paraminfo_t::PARAM_U8:
-          result = sscanf(str.c_str(), FMT_U8_PSTR, (uint8_t*)ptr) == 1;
+          result = parseUInt(str, u32, UINT8_MAX);
+          if (result)
+            *(uint8_t*)ptr = u32;
           break;
         case paraminfo_t::PARAM_I16:
-          result = sscanf(str.c_str(), FMT_I16_PSTR, (int16_t*)ptr) == 1;
+          result = parseInt(str, i32, INT16_MIN, INT16_MAX);
+          if (result)
+            *(int16_t*)ptr = i32;
           break;
         case paraminfo_t::PARAM_U16:
-          result = sscanf(str.c_str(), FMT_U16_PSTR, (uint16_t*)ptr) == 1;
+          result = parseUInt(str, u32, UINT16_MAX);
+          if (result)
+            *(uint16_t*)ptr = u32;
           break;
         case paraminfo_t::PARAM_I32:
-          result = sscanf(str.c_str(), FMT_I32_PSTR, (int32_t*)ptr) == 1;
+          result = parseInt(str, *(int32_t*)ptr);
           break;
         case paraminfo_t::PARAM_U32:
-          result = sscanf(str.c_str(), FMT_U32_PSTR, (uint32_t*)ptr) == 1;
+          result = parseUInt(str, *(uint32_t*)ptr);
           break;
         case paraminfo_t::PARAM_FLOAT:
-          result = sscanf(str.c_str(), FMT_FLOAT_PSTR, (float*)ptr) == 1;
+          result = parseFloat(str, *(float*)ptr);
           break;
         case paraminfo_t::PARAM_CHAR:
           *(char*)ptr = str[0];
           result = true;
           break;
         case paraminfo_t::PARAM_STR:
-          strncpy((char*)ptr, str.c_str(), _params[index].size - 1);
-          ((char*)ptr)[_params[index].size - 1] = '\0';
+          strncpy((char*)ptr, str, desc(index)->size - 1);
+          ((char*)ptr)[desc(index)->size - 1] = '\0';
           result = true;
           break;
         case paraminfo_t::PARAM_BINARY:
-          result = decodeBase64(str.c_str(), (uint8_t*)ptr, _params[index].size) != -1;
+          result = decodeBase64(str, (uint8_t*)ptr, desc(index)->size) != -1;
           break;
         case paraminfo_t::PARAM_IP:
-          result = sscanf(str.c_str(), FMT_IP_PSTR, &(*(paraminfo_t::ipaddr_t*)ptr)[0], &(*(paraminfo_t::ipaddr_t*)ptr)[1],
-            &(*(paraminfo_t::ipaddr_t*)ptr)[2], &(*(paraminfo_t::ipaddr_t*)ptr)[3]) == 4;
+          result = parseIP(str, (uint8_t*)ptr);
           break;
       }
-      if (! result) {
-        clear(index);
-      }
+      result = complete(index, result);
     }
   }
   return result;
 }
 #endif
 
+bool Parameters::fromString(uint16_t index, const String &str) {
+  return parse(index, str.c_str());
+}
+
+/*
+ * Reads one line (up to CR, LF or CR LF) without waiting for stream timeout, the rest of the line
+ * that does not fit into the field is discarded, so the next value starts at the next line.
+ * PARAM_STR and PARAM_BINARY are decoded straight into the field, other types via small stack buffer
+ */
 bool Parameters::fromStream(uint16_t index, Stream &stream) {
   if (_inited && (index < _count)) {
-    return fromString(index, stream.readString());
+    uint16_t fieldSize = size(index);
+    char c;
+
+    switch (type(index)) {
+      case paraminfo_t::PARAM_STR:
+        {
+          char *str = (char*)getPtr(index);
+          uint16_t len = 0;
+
+          while ((len < fieldSize - 1) && readLineChar(stream, c))
+            str[len++] = c;
+          if (len >= fieldSize - 1) // Delimiter is not read yet
+            skipLine(stream);
+          memset(&str[len], 0, fieldSize - len);
+          return complete(index, true);
+        }
+      case paraminfo_t::PARAM_BINARY:
+        return complete(index, decodeBase64(stream, (uint8_t*)getPtr(index), fieldSize) != -1);
+      default:
+        {
+          char str[32];
+          uint8_t len = 0;
+
+          while (readLineChar(stream, c)) {
+            if (len >= sizeof(str) - 1) { // Too long for any number
+              skipLine(stream);
+              return complete(index, false);
+            }
+            str[len++] = c;
+          }
+          str[len] = '\0';
+          return parse(index, str);
+        }
+    }
   }
   return false;
 }
 
+bool Parameters::complete(uint16_t index, bool result) {
+  if (result)
+    result = validate(index);
+  if (result) {
+    markDirty(index);
+  } else if (_txData) { // Whole transaction will be rolled back
+    _txFailed = true;
+  } else {
+    clear(index);
+  }
+  return result;
+}
+
+static uint8_t editorByte(const uint8_t *&data) {
+#ifdef ESP8266
+  return pgm_read_byte(data++);
+#else
+  return *data++;
+#endif
+}
+
+static uint16_t editorNumber(const uint8_t *&data, bool wide) {
+  uint16_t result = editorByte(data);
+
+  if (wide)
+    result |= editorByte(data) << 8;
+  return result;
+}
+
+static const char *editorString(const uint8_t *data, uint16_t offset) {
+  if (offset == parameditor_t::NO_STRING)
+    return NULL;
+  return (const char*)&data[offset];
+}
+
+static const char *const *editorList(const char *const *const *lists, uint8_t list) {
+  if (list == parameditor_t::NO_LIST)
+    return NULL;
+#ifdef ESP8266
+  return (const char *const*)pgm_read_ptr(&lists[list]);
+#else
+  return lists[list];
+#endif
+}
+
+const uint8_t *Parameters::editorRecord(uint16_t index) const {
 #ifdef ESP8266
-String Parameters::getScript() {
-  return String(F("<script type=\"text/javascript\">\n"
-    "function getXmlHttpRequest(){\n"
-    "let x;\n"
-    "try{\n"
-    "x=new ActiveXObject(\"Msxml2.XMLHTTP\");\n"
-    "}catch(e){\n"
-    "try{\n"
-    "x=newActiveXObject(\"Microsoft.XMLHTTP\");\n"
-    "}catch(E){\n"
-    "x=false;\n"
-    "}\n"
-    "}\n"
-    "if((!x)&&(typeof XMLHttpRequest!='undefined')){\n"
-    "x=new XMLHttpRequest();\n"
-    "}\n"
-    "return x;\n"
-    "}\n"
-    "function openUrl(u,m){\n"
-    "let x=getXmlHttpRequest();\n"
-    "x.open(m,u,false);\n"
-    "x.send(null);\n"
-    "if(x.status!=200){\n"
-    "alert(x.responseText);\n"
-    "return false;\n"
-    "}\n"
-    "return true;\n"
-    "}\n"
-    "function checkInt(e,d,m,x){\n"
-    "let n=parseInt(e.value);\n"
-    "if(isNaN(n)){\n"
-    "n=d;\n"
-    "}else{\n"
-    "if(n<m)n=m;\n"
-    "if(n>x)n=x;\n"
-    "}\n"
-    "e.value=n.toString();\n"
-    "}\n"
-    "function checkFloat(e,d,m,x){\n"
-    "let n=parseFloat(e.value);\n"
-    "if(isNaN(n)){\n"
-    "n=d;\n"
-    "}else{\n"
-    "if((!isNaN(m))&&(n<m))n=m;\n"
-    "if((!isNaN(x))&&(n>x))n=x;\n"
-    "}\n"
-    "if(isNaN(n)){e.value=\"\";\n"
-    "}else{\n"
-    "e.value=n.toString();\n"
-    "}\n"
-    "}\n"
-    "function processTab(t,e){\n"
-    "if(e.which==9){\n"
-    "let start=t.selectionStart;\n"
-    "let end=t.selectionEnd;\n"
-    "t.value=t.value.substr(0,start)+'\t'+t.value.substr(end);\n"
-    "t.selectionStart=t.selectionEnd=start+1;\n"
-    "e.preventDefault();\n"
-    "return false;\n"
-    "}\n"
-    "}\n"
-    "</script>\n"));
+  return _editorData + pgm_read_word(&_editorIndex[index]);
+#else
+  return _editorData + _editorIndex[index];
+#endif
 }
+
+editor_t::editortype_t Parameters::editorType(uint16_t index) const {
+  if (_editorIndex) {
+    const uint8_t *record = editorRecord(index);
+
+    return (editor_t::editortype_t)(editorByte(record) & parameditor_t::TYPE_MASK);
+  }
+#ifdef ESP8266
+  return (editor_t::editortype_t)pgm_read_byte(&((const paraminfo_t*)desc(index))->editor.type);
 #else
-String Parameters::getScript() {
-  return String("<script type=\"text/javascript\">\n"
-    "function getXmlHttpRequest(){\n"
-    "let x;\n"
-    "try{\n"
-    "x=new ActiveXObject(\"Msxml2.XMLHTTP\");\n"
-    "}catch(e){\n"
-    "try{\n"
-    "x=newActiveXObject(\"Microsoft.XMLHTTP\");\n"
-    "}catch(E){\n"
-    "x=false;\n"
-    "}\n"
-    "}\n"
-    "if((!x)&&(typeof XMLHttpRequest!='undefined')){\n"
-    "x=new XMLHttpRequest();\n"
-    "}\n"
-    "return x;\n"
-    "}\n"
-    "function openUrl(u,m){\n"
-    "let x=getXmlHttpRequest();\n"
-    "x.open(m,u,false);\n"
-    "x.send(null);\n"
-    "if(x.status!=200){\n"
-    "alert(x.responseText);\n"
-    "return false;\n"
-    "}\n"
-    "return true;\n"
-    "}\n"
-    "function checkInt(e,d,m,x){\n"
-    "let n=parseInt(e.value);\n"
-    "if(isNaN(n)){\n"
-    "n=d;\n"
-    "}else{\n"
-    "if(n<m)n=m;\n"
-    "if(n>x)n=x;\n"
-    "}\n"
-    "e.value=n.toString();\n"
-    "}\n"
-    "function checkFloat(e,d,m,x){\n"
-    "let n=parseFloat(e.value);\n"
-    "if(isNaN(n)){\n"
-    "n=d;\n"
-    "}else{\n"
-    "if((!isNaN(m))&&(n<m))n=m;\n"
-    "if((!isNaN(x))&&(n>x))n=x;\n"
-    "}\n"
-    "if(isNaN(n)){e.value=\"\";\n"
-    "}else{\n"
-    "e.value=n.toString();\n"
-    "}\n"
-    "}\n"
-    "function processTab(t,e){\n"
-    "if(e.which==9){\n"
-    "let start=t.selectionStart;\n"
-    "let end=t.selectionEnd;\n"
-    "t.value=t.value.substr(0,start)+'\t'+t.value.substr(end);\n"
-    "t.selectionStart=t.selectionEnd=start+1;\n"
-    "e.preventDefault();\n"
-    "return false;\n"
-    "}\n"
-    "}\n"
-    "</script>\n");
+  return ((const paraminfo_t*)desc(index))->editor.type;
+#endif
 }
+
+void Parameters::getEditor(uint16_t index, editor_t &editor) const {
+  if (! _editorIndex) {
+#ifdef ESP8266
+    memcpy_P(&editor, &((const paraminfo_t*)desc(index))->editor, sizeof(editor_t));
+#else
+    editor = ((const paraminfo_t*)desc(index))->editor;
 #endif
+    return;
+  }
+
+  const uint8_t *record = editorRecord(index);
+  uint8_t flags = editorByte(record);
+  bool wide = flags & parameditor_t::WIDE;
+
+  memset(&editor, 0, sizeof(editor_t));
+  editor.type = (editor_t::editortype_t)(flags & parameditor_t::TYPE_MASK);
+  editor.disabled = flags & parameditor_t::DISABLED;
+  editor.required = flags & parameditor_t::REQUIRED;
+  editor.readonly = flags & parameditor_t::READONLY;
+  switch (editor.type) {
+    case editor_t::EDIT_TEXT:
+    case editor_t::EDIT_PASSWORD:
+      editor.text.size = editorNumber(record, wide);
+      editor.text.maxlength = editorNumber(record, wide);
+      break;
+    case editor_t::EDIT_TEXTAREA:
+      editor.textarea.cols = editorNumber(record, wide);
+      editor.textarea.rows = editorNumber(record, wide);
+      editor.textarea.maxlength = editorNumber(record, wide);
+      break;
+    case editor_t::EDIT_CHECKBOX:
+      editor.checkbox.checkedvalue = editorString(_editorData, editorNumber(record, true));
+      editor.checkbox.uncheckedvalue = editorString(_editorData, editorNumber(record, true));
+      break;
+    case editor_t::EDIT_RADIO:
+      editor.radio.count = editorByte(record);
+      editor.radio.values = editorList(_editorLists, editorByte(record));
+      editor.radio.titles = editorList(_editorLists, editorByte(record));
+      break;
+    case editor_t::EDIT_SELECT:
+      editor.select.size = editorByte(record);
+      editor.select.count = editorByte(record);
+      editor.select.values = editorList(_editorLists, editorByte(record));
+      editor.select.titles = editorList(_editorLists, editorByte(record));
+      break;
+    default:
+      break;
+  }
+}
 
 #ifdef ESP8266
-String Parameters::getEditor(uint16_t index) {
+void Parameters::editorToStream(uint16_t index, Stream &stream) {
   static const char DISABLED_PSTR[] PROGMEM = " disabled";
   static const char REQUIRED_PSTR[] PROGMEM = " required";
   static const char READONLY_PSTR[] PROGMEM = " readonly";
@@ -726,221 +853,218 @@ String Parameters::getEditor(uint16_t index) {
   static const char MAXLENGTH_PSTR[] PROGMEM = " maxlength=";
   static const char NAN_PSTR[] PROGMEM = "NaN";
 
-  if (_inited && (index < _count) && (pgm_read_byte(&_params[index].editor.type) != editor_t::EDIT_NONE) && getPtr(index)) {
-    StreamString result;
+  if (_inited && (index < _count) && (editorType(index) != editor_t::EDIT_NONE) && getPtr(index)) {
     editor_t editor;
+    char buf[FORMAT_SIZE];
+    const char *current; // Value formatted once to compare with options
 
-    memcpy_P(&editor, &_params[index].editor, sizeof(editor_t));
+    getEditor(index, editor);
     if (editor.type == editor_t::EDIT_SELECT) {
-      result.print(F("<select name=\""));
-      result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-      result.print('"');
+      stream.print(F("<select name=\""));
+      stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+      stream.print('"');
       if (editor.select.size) {
-        result.print(FPSTR(SIZE_PSTR));
-        result.print(editor.select.size);
+        stream.print(FPSTR(SIZE_PSTR));
+        stream.print(editor.select.size);
       }
       if (editor.disabled) {
-        result.print(FPSTR(DISABLED_PSTR));
+        stream.print(FPSTR(DISABLED_PSTR));
       }
       if (editor.required) {
-        result.print(FPSTR(REQUIRED_PSTR));
+        stream.print(FPSTR(REQUIRED_PSTR));
       }
-      result.print(F(">\n"));
+      stream.print(F(">\n"));
       if (editor.select.count && editor.select.values) {
+        current = format(index, buf);
         for (uint16_t i = 0; i < editor.select.count; ++i) {
-          result.print(F("<option value=\""));
-          result.print(encodeString((char*)pgm_read_ptr(&editor.select.values[i])));
-          result.print('"');
-          if (toString(index).equals(FPSTR((char*)pgm_read_ptr(&editor.select.values[i])))) {
-            result.print(FPSTR(SELECTED_PSTR));
+          const char *value = (char*)pgm_read_ptr(&editor.select.values[i]);
+
+          stream.print(F("<option value=\""));
+          encodeString(stream, value);
+          stream.print('"');
+          if (current && (! strcmp_P(current, value))) {
+            stream.print(FPSTR(SELECTED_PSTR));
           }
-          result.print('>');
+          stream.print('>');
           if (editor.select.titles)
-            result.print(encodeString((char*)pgm_read_ptr(&editor.select.titles[i])));
+            encodeString(stream, (char*)pgm_read_ptr(&editor.select.titles[i]));
           else
-            result.print(encodeString((char*)pgm_read_ptr(&editor.select.values[i])));
-          result.print(F("</option>\n"));
+            encodeString(stream, value);
+          stream.print(F("</option>\n"));
         }
       }
-      result.print(F("</select>"));
+      stream.print(F("</select>"));
     } else if (editor.type == editor_t::EDIT_RADIO) {
       if (editor.radio.count && editor.radio.values) {
+        current = format(index, buf);
         for (uint16_t i = 0; i < editor.radio.count; ++i) {
-          result.print(F("<input type=\"radio\" name=\""));
-          result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-          result.print(F("\" value=\""));
-          result.print(encodeString((char*)pgm_read_ptr(&editor.radio.values[i])));
-          result.print('"');
-          if (toString(index).equals(FPSTR((char*)pgm_read_ptr(&editor.radio.values[i])))) {
-            result.print(FPSTR(CHECKED_PSTR));
+          const char *value = (char*)pgm_read_ptr(&editor.radio.values[i]);
+
+          stream.print(F("<input type=\"radio\" name=\""));
+          stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+          stream.print(F("\" value=\""));
+          encodeString(stream, value);
+          stream.print('"');
+          if (current && (! strcmp_P(current, value))) {
+            stream.print(FPSTR(CHECKED_PSTR));
           }
           if (editor.disabled) {
-            result.print(FPSTR(DISABLED_PSTR));
+            stream.print(FPSTR(DISABLED_PSTR));
           }
           if (editor.required) {
-            result.print(FPSTR(REQUIRED_PSTR));
+            stream.print(FPSTR(REQUIRED_PSTR));
           }
           if (editor.readonly) {
-            result.print(F(" onclick=\"return false;\""));
+            stream.print(F(" onclick=\"return false;\""));
           }
-          result.print('>');
+          stream.print('>');
           if (editor.radio.titles)
-            result.print(encodeString((char*)pgm_read_ptr(&editor.radio.titles[i])));
+            encodeString(stream, (char*)pgm_read_ptr(&editor.radio.titles[i]));
           else
-            result.print(encodeString((char*)pgm_read_ptr(&editor.radio.values[i])));
-          result.print('\n');
+            encodeString(stream, value);
+          stream.print('\n');
         }
       }
     } else if (editor.type == editor_t::EDIT_TEXTAREA) {
-      result.print(F("<textarea name=\""));
-      result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-      result.print('"');
+      stream.print(F("<textarea name=\""));
+      stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+      stream.print('"');
       if (editor.textarea.cols) {
-        result.print(F(" cols="));
-        result.print(editor.textarea.cols);
+        stream.print(F(" cols="));
+        stream.print(editor.textarea.cols);
       }
       if (editor.textarea.rows) {
-        result.print(F(" rows="));
-        result.print(editor.textarea.rows);
+        stream.print(F(" rows="));
+        stream.print(editor.textarea.rows);
       }
       if (editor.textarea.maxlength) {
-        result.print(FPSTR(MAXLENGTH_PSTR));
-        result.print(editor.textarea.maxlength);
+        stream.print(FPSTR(MAXLENGTH_PSTR));
+        stream.print(editor.textarea.maxlength);
       }
       if (editor.disabled) {
-        result.print(FPSTR(DISABLED_PSTR));
+        stream.print(FPSTR(DISABLED_PSTR));
       }
       if (editor.required) {
-        result.print(FPSTR(REQUIRED_PSTR));
+        stream.print(FPSTR(REQUIRED_PSTR));
       }
       if (editor.readonly) {
-        result.print(FPSTR(READONLY_PSTR));
+        stream.print(FPSTR(READONLY_PSTR));
       }
-      result.print(F(" onkeydown=\"processTab(this,event);\">"));
-      toStream(index, result, true);
-      result.print(F("</textarea>"));
+      stream.print(F(" onkeydown=\"processTab(this,event);\">"));
+      toStream(index, stream, true);
+      stream.print(F("</textarea>"));
     } else {
-      result.print(F("<input type=\""));
+      stream.print(F("<input type=\""));
       if (editor.type == editor_t::EDIT_TEXT)
-        result.print(F("text"));
+        stream.print(F("text"));
       else if (editor.type == editor_t::EDIT_PASSWORD)
-        result.print(F("password"));
+        stream.print(F("password"));
       else if (editor.type == editor_t::EDIT_CHECKBOX)
-        result.print(F("checkbox"));
+        stream.print(F("checkbox"));
       else if (editor.type == editor_t::EDIT_HIDDEN)
-        result.print(F("hidden"));
-      result.print(F("\" name=\""));
-      result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-      result.print('"');
+        stream.print(F("hidden"));
+      stream.print(F("\" name=\""));
+      stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+      stream.print('"');
       if (editor.type != editor_t::EDIT_HIDDEN) {
         if (editor.disabled) {
-          result.print(FPSTR(DISABLED_PSTR));
+          stream.print(FPSTR(DISABLED_PSTR));
         }
         if (editor.required) {
-          result.print(FPSTR(REQUIRED_PSTR));
+          stream.print(FPSTR(REQUIRED_PSTR));
         }
       }
       if ((editor.type == editor_t::EDIT_TEXT) || (editor.type == editor_t::EDIT_PASSWORD)) {
         if (editor.text.size) {
-          result.print(FPSTR(SIZE_PSTR));
-          result.print(editor.text.size);
+          stream.print(FPSTR(SIZE_PSTR));
+          stream.print(editor.text.size);
         }
         if (editor.text.maxlength) {
-          result.print(FPSTR(MAXLENGTH_PSTR));
-          result.print(editor.text.maxlength);
+          stream.print(FPSTR(MAXLENGTH_PSTR));
+          stream.print(editor.text.maxlength);
         }
         if (editor.readonly) {
-          result.print(FPSTR(READONLY_PSTR));
+          stream.print(FPSTR(READONLY_PSTR));
         }
       } else if (editor.type == editor_t::EDIT_CHECKBOX) {
-        result.print(F(" value=\""));
-        result.print(encodeString((char*)pgm_read_ptr(&editor.checkbox.checkedvalue)));
-        result.print('"');
-        if (toString(index).equals(FPSTR((char*)pgm_read_ptr(&editor.checkbox.checkedvalue)))) {
-          result.print(FPSTR(CHECKED_PSTR));
+        const char *checkedvalue = (char*)pgm_read_ptr(&editor.checkbox.checkedvalue);
+        bool checked;
+
+        current = format(index, buf);
+        checked = current && checkedvalue && (! strcmp_P(current, checkedvalue));
+        stream.print(F(" value=\""));
+        encodeString(stream, checkedvalue);
+        stream.print('"');
+        if (checked) {
+          stream.print(FPSTR(CHECKED_PSTR));
         }
         if (editor.readonly) {
-          result.print(F(" onclick=\"return false;\""));
+          stream.print(F(" onclick=\"return false;\""));
         } else {
-          result.print(F(" onchange=\"document.getElementsByName('"));
-          result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-          result.print(F("')[1].disabled=this.checked;\""));
+          stream.print(F(" onchange=\"document.getElementsByName('"));
+          stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+          stream.print(F("')[1].disabled=this.checked;\""));
         }
-        result.print(F("><input type=\"hidden\" name=\""));
-        result.print(FPSTR((char*)pgm_read_ptr(&_params[index].name)));
-        result.print(F("\" value=\""));
-        result.print(encodeString((char*)pgm_read_ptr(&editor.checkbox.uncheckedvalue)));
-        result.print('"');
-        if (toString(index).equals(FPSTR((char*)pgm_read_ptr(&editor.checkbox.checkedvalue)))) {
-          result.print(FPSTR(DISABLED_PSTR));
+        stream.print(F("><input type=\"hidden\" name=\""));
+        stream.print(FPSTR((char*)pgm_read_ptr(&desc(index)->name)));
+        stream.print(F("\" value=\""));
+        encodeString(stream, (char*)pgm_read_ptr(&editor.checkbox.uncheckedvalue));
+        stream.print('"');
+        if (checked) {
+          stream.print(FPSTR(DISABLED_PSTR));
         }
-        result.print('>');
+        stream.print('>');
       }
       if ((editor.type == editor_t::EDIT_TEXT) || (editor.type == editor_t::EDIT_PASSWORD) ||
         (editor.type == editor_t::EDIT_HIDDEN)) {
-        result.print(F(" value=\""));
-        toStream(index, result, true);
-        result.print('"');
+        stream.print(F(" value=\""));
+        toStream(index, stream, true);
+        stream.print('"');
         if (editor.type == editor_t::EDIT_TEXT) {
           if (! editor.readonly) {
-            paraminfo_t::paramtype_t type = (paraminfo_t::paramtype_t)pgm_read_byte(&_params[index].type);
+            paraminfo_t::paramtype_t type = (paraminfo_t::paramtype_t)pgm_read_byte(&desc(index)->type);
 
             if ((type >= paraminfo_t::PARAM_I8) && (type <= paraminfo_t::PARAM_U32)) { // Integers
-              result.print(F(" onblur=\"checkInt(this,"));
-              if ((type == paraminfo_t::PARAM_I8) || (type == paraminfo_t::PARAM_I16) ||
-                (type == paraminfo_t::PARAM_I32)) {
-                result.printf_P(FMT_I32_PSTR, (int32_t)pgm_read_dword(&_params[index].defvalue.asint));
-              } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf_P(FMT_U32_PSTR, pgm_read_dword(&_params[index].defvalue.asuint));
-              }
-              result.print(',');
-              if ((type == paraminfo_t::PARAM_I8) || (type == paraminfo_t::PARAM_I16) ||
-                (type == paraminfo_t::PARAM_I32)) {
-                result.printf_P(FMT_I32_PSTR, (int32_t)pgm_read_dword(&_params[index].minvalue.asint));
-              } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf_P(FMT_U32_PSTR, pgm_read_dword(&_params[index].minvalue.asuint));
-              }
-              result.print(',');
+              stream.print(F(" onblur=\"checkInt(this,"));
               if ((type == paraminfo_t::PARAM_I8) || (type == paraminfo_t::PARAM_I16) ||
                 (type == paraminfo_t::PARAM_I32)) {
-                result.printf_P(FMT_I32_PSTR, (int32_t)pgm_read_dword(&_params[index].maxvalue.asint));
+                stream.write((uint8_t*)buf, formatInt(buf, (int32_t)pgm_read_dword(&desc(index)->defvalue.asint)));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatInt(buf, (int32_t)pgm_read_dword(&desc(index)->minvalue.asint)));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatInt(buf, (int32_t)pgm_read_dword(&desc(index)->maxvalue.asint)));
               } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf_P(FMT_U32_PSTR, pgm_read_dword(&_params[index].maxvalue.asuint));
+                stream.write((uint8_t*)buf, formatUInt(buf, pgm_read_dword(&desc(index)->defvalue.asuint)));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatUInt(buf, pgm_read_dword(&desc(index)->minvalue.asuint)));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatUInt(buf, pgm_read_dword(&desc(index)->maxvalue.asuint)));
               }
-              result.print(F(");\""));
+              stream.print(F(");\""));
             } else if (type == paraminfo_t::PARAM_FLOAT) {
-              result.print(F(" onblur=\"checkFloat(this,"));
-              if (isnan(pgm_read_float(&_params[index].defvalue.asfloat))) {
-                result.print(FPSTR(NAN_PSTR));
-              } else {
-                result.printf_P(FMT_FLOAT_PSTR, pgm_read_float(&_params[index].defvalue.asfloat));
-              }
-              result.print(',');
-              if (isnan(pgm_read_float(&_params[index].minvalue.asfloat))) {
-                result.print(FPSTR(NAN_PSTR));
-              } else {
-                result.printf_P(FMT_FLOAT_PSTR, pgm_read_float(&_params[index].minvalue.asfloat));
+              const float values[3] = { pgm_read_float(&desc(index)->defvalue.asfloat),
+                pgm_read_float(&desc(index)->minvalue.asfloat), pgm_read_float(&desc(index)->maxvalue.asfloat) };
+
+              stream.print(F(" onblur=\"checkFloat(this"));
+              for (uint8_t i = 0; i < 3; ++i) {
+                stream.print(',');
+                if (isnan(values[i]))
+                  stream.print(FPSTR(NAN_PSTR));
+                else
+                  stream.write((uint8_t*)buf, formatFloat(buf, values[i]));
               }
-              result.print(',');
-              if (isnan(pgm_read_float(&_params[index].maxvalue.asfloat))) {
-                result.print(FPSTR(NAN_PSTR));
-              } else {
-                result.printf_P(FMT_FLOAT_PSTR, pgm_read_float(&_params[index].maxvalue.asfloat));
-              }
-              result.print(F(");\""));
+              stream.print(F(");\""));
             }
           }
         }
-        result.print('>');
+        stream.print('>');
       }
     }
-    return result;
   }
-  return String();
 }
 
 #else
-String Parameters::getEditor(uint16_t index) {
+void Parameters::editorToStream(uint16_t index, Stream &stream) {
   static const char DISABLED_PSTR[] = " disabled";
   static const char REQUIRED_PSTR[] = " required";
   static const char READONLY_PSTR[] = " readonly";
@@ -950,224 +1074,229 @@ String Parameters::getEditor(uint16_t index) {
   static const char MAXLENGTH_PSTR[] = " maxlength=";
   static const char NAN_PSTR[] = "NaN";
 
-  if (_inited && (index < _count) && (_params[index].editor.type != editor_t::EDIT_NONE) && getPtr(index)) {
-    StreamString result;
+  if (_inited && (index < _count) && (editorType(index) != editor_t::EDIT_NONE) && getPtr(index)) {
+    editor_t editor;
+    char buf[FORMAT_SIZE];
+    const char *current; // Value formatted once to compare with options
 
-    if (_params[index].editor.type == editor_t::EDIT_SELECT) {
-      result.print("<select name=\"");
-      result.print(_params[index].name);
-      result.print('"');
-      if (_params[index].editor.select.size) {
-        result.print(SIZE_PSTR);
-        result.print(_params[index].editor.select.size);
+    getEditor(index, editor);
+    if (editor.type == editor_t::EDIT_SELECT) {
+      stream.print("<select name=\"");
+      stream.print(desc(index)->name);
+      stream.print('"');
+      if (editor.select.size) {
+        stream.print(SIZE_PSTR);
+        stream.print(editor.select.size);
       }
-      if (_params[index].editor.disabled) {
-        result.print(DISABLED_PSTR);
+      if (editor.disabled) {
+        stream.print(DISABLED_PSTR);
       }
-      if (_params[index].editor.required) {
-        result.print(REQUIRED_PSTR);
+      if (editor.required) {
+        stream.print(REQUIRED_PSTR);
       }
-      result.print(">\n");
-      if (_params[index].editor.select.count && _params[index].editor.select.values) {
-        for (uint16_t i = 0; i < _params[index].editor.select.count; ++i) {
-          result.print("<option value=\"");
-          result.print(encodeString(_params[index].editor.select.values[i]));
-          result.print('"');
-          if (toString(index).equals(_params[index].editor.select.values[i])) {
-            result.print(SELECTED_PSTR);
+      stream.print(">\n");
+      if (editor.select.count && editor.select.values) {
+        current = format(index, buf);
+        for (uint16_t i = 0; i < editor.select.count; ++i) {
+          const char *value = editor.select.values[i];
+
+          stream.print("<option value=\"");
+          encodeString(stream, value);
+          stream.print('"');
+          if (current && (! strcmp(current, value))) {
+            stream.print(SELECTED_PSTR);
           }
-          result.print('>');
-          if (_params[index].editor.select.titles)
-            result.print(encodeString(_params[index].editor.select.titles[i]));
+          stream.print('>');
+          if (editor.select.titles)
+            encodeString(stream, editor.select.titles[i]);
           else
-            result.print(encodeString(_params[index].editor.select.values[i]));
-          result.print("</option>\n");
+            encodeString(stream, value);
+          stream.print("</option>\n");
         }
       }
-      result.print("</select>");
-    } else if (_params[index].editor.type == editor_t::EDIT_RADIO) {
-      if (_params[index].editor.radio.count && _params[index].editor.radio.values) {
-        for (uint16_t i = 0; i < _params[index].editor.radio.count; ++i) {
-          result.print("<input type=\"radio\" name=\"");
-          result.print(_params[index].name);
-          result.print("\" value=\"");
-          result.print(encodeString(_params[index].editor.radio.values[i]));
-          result.print('"');
-          if (toString(index).equals(_params[index].editor.radio.values[i])) {
-            result.print(CHECKED_PSTR);
+      stream.print("</select>");
+    } else if (editor.type == editor_t::EDIT_RADIO) {
+      if (editor.radio.count && editor.radio.values) {
+        current = format(index, buf);
+        for (uint16_t i = 0; i < editor.radio.count; ++i) {
+          const char *value = editor.radio.values[i];
+
+          stream.print("<input type=\"radio\" name=\"");
+          stream.print(desc(index)->name);
+          stream.print("\" value=\"");
+          encodeString(stream, value);
+          stream.print('"');
+          if (current && (! strcmp(current, value))) {
+            stream.print(CHECKED_PSTR);
           }
-          if (_params[index].editor.disabled) {
-            result.print(DISABLED_PSTR);
+          if (editor.disabled) {
+            stream.print(DISABLED_PSTR);
           }
-          if (_params[index].editor.required) {
-            result.print(REQUIRED_PSTR);
+          if (editor.required) {
+            stream.print(REQUIRED_PSTR);
           }
-          if (_params[index].editor.readonly) {
-            result.print(" onclick=\"return false;\"");
+          if (editor.readonly) {
+            stream.print(" onclick=\"return false;\"");
           }
-          result.print('>');
-          if (_params[index].editor.radio.titles)
-            result.print(encodeString(_params[index].editor.radio.titles[i]));
+          stream.print('>');
+          if (editor.radio.titles)
+            encodeString(stream, editor.radio.titles[i]);
           else
-            result.print(encodeString(_params[index].editor.radio.values[i]));
-          result.print('\n');
+            encodeString(stream, value);
+          stream.print('\n');
         }
       }
-    } else if (_params[index].editor.type == editor_t::EDIT_TEXTAREA) {
-      result.print("<textarea name=\"");
-      result.print(_params[index].name);
-      result.print('"');
-      if (_params[index].editor.textarea.cols) {
-        result.print(" cols=");
-        result.print(_params[index].editor.textarea.cols);
+    } else if (editor.type == editor_t::EDIT_TEXTAREA) {
+      stream.print("<textarea name=\"");
+      stream.print(desc(index)->name);
+      stream.print('"');
+      if (editor.textarea.cols) {
+        stream.print(" cols=");
+        stream.print(editor.textarea.cols);
       }
-      if (_params[index].editor.textarea.rows) {
-        result.print(" rows=");
-        result.print(_params[index].editor.textarea.rows);
+      if (editor.textarea.rows) {
+        stream.print(" rows=");
+        stream.print(editor.textarea.rows);
       }
-      if (_params[index].editor.textarea.maxlength) {
-        result.print(MAXLENGTH_PSTR);
-        result.print(_params[index].editor.textarea.maxlength);
+      if (editor.textarea.maxlength) {
+        stream.print(MAXLENGTH_PSTR);
+        stream.print(editor.textarea.maxlength);
       }
-      if (_params[index].editor.disabled) {
-        result.print(DISABLED_PSTR);
+      if (editor.disabled) {
+        stream.print(DISABLED_PSTR);
       }
-      if (_params[index].editor.required) {
-        result.print(REQUIRED_PSTR);
+      if (editor.required) {
+        stream.print(REQUIRED_PSTR);
       }
-      if (_params[index].editor.readonly) {
-        result.print(READONLY_PSTR);
+      if (editor.readonly) {
+        stream.print(READONLY_PSTR);
       }
-      result.print(" onkeydown=\"processTab(this,event);\">");
-      toStream(index, result, true);
-      result.print("</textarea>");
+      stream.print(" onkeydown=\"processTab(this,event);\">");
+      toStream(index, stream, true);
+      stream.print("</textarea>");
     } else {
-      result.print("<input type=\"");
-      if (_params[index].editor.type == editor_t::EDIT_TEXT)
-        result.print("text");
-      else if (_params[index].editor.type == editor_t::EDIT_PASSWORD)
-        result.print("password");
-      else if (_params[index].editor.type == editor_t::EDIT_CHECKBOX)
-        result.print("checkbox");
-      else if (_params[index].editor.type == editor_t::EDIT_HIDDEN)
-        result.print("hidden");
-      result.print("\" name=\"");
-      result.print(_params[index].name);
-      result.print('"');
-      if (_params[index].editor.type != editor_t::EDIT_HIDDEN) {
-        if (_params[index].editor.disabled) {
-          result.print(DISABLED_PSTR);
+      stream.print("<input type=\"");
+      if (editor.type == editor_t::EDIT_TEXT)
+        stream.print("text");
+      else if (editor.type == editor_t::EDIT_PASSWORD)
+        stream.print("password");
+      else if (editor.type == editor_t::EDIT_CHECKBOX)
+        stream.print("checkbox");
+      else if (editor.type == editor_t::EDIT_HIDDEN)
+        stream.print("hidden");
+      stream.print("\" name=\"");
+      stream.print(desc(index)->name);
+      stream.print('"');
+      if (editor.type != editor_t::EDIT_HIDDEN) {
+        if (editor.disabled) {
+          stream.print(DISABLED_PSTR);
         }
-        if (_params[index].editor.required) {
-          result.print(REQUIRED_PSTR);
+        if (editor.required) {
+          stream.print(REQUIRED_PSTR);
         }
       }
-      if ((_params[index].editor.type == editor_t::EDIT_TEXT) || (_params[index].editor.type == editor_t::EDIT_PASSWORD)) {
-        if (_params[index].editor.text.size) {
-          result.print(SIZE_PSTR);
-          result.print(_params[index].editor.text.size);
+      if ((editor.type == editor_t::EDIT_TEXT) || (editor.type == editor_t::EDIT_PASSWORD)) {
+        if (editor.text.size) {
+          stream.print(SIZE_PSTR);
+          stream.print(editor.text.size);
         }
-        if (_params[index].editor.text.maxlength) {
-          result.print(MAXLENGTH_PSTR);
-          result.print(_params[index].editor.text.maxlength);
+        if (editor.text.maxlength) {
+          stream.print(MAXLENGTH_PSTR);
+          stream.print(editor.text.maxlength);
         }
-        if (_params[index].editor.readonly) {
-          result.print(READONLY_PSTR);
+        if (editor.readonly) {
+          stream.print(READONLY_PSTR);
         }
-      } else if (_params[index].editor.type == editor_t::EDIT_CHECKBOX) {
-        result.print(" value=\"");
-        result.print(encodeString(_params[index].editor.checkbox.checkedvalue));
-        result.print('"');
-        if (toString(index).equals(_params[index].editor.checkbox.checkedvalue)) {
-          result.print(CHECKED_PSTR);
+      } else if (editor.type == editor_t::EDIT_CHECKBOX) {
+        const char *checkedvalue = editor.checkbox.checkedvalue;
+        bool checked;
+
+        current = format(index, buf);
+        checked = current && checkedvalue && (! strcmp(current, checkedvalue));
+        stream.print(" value=\"");
+        encodeString(stream, checkedvalue);
+        stream.print('"');
+        if (checked) {
+          stream.print(CHECKED_PSTR);
         }
-        if (_params[index].editor.readonly) {
-          result.print(" onclick=\"return false;\"");
+        if (editor.readonly) {
+          stream.print(" onclick=\"return false;\"");
         } else {
-          result.print(" onchange=\"document.getElementsByName('");
-          result.print(_params[index].name);
-          result.print("')[1].disabled=this.checked;\"");
+          stream.print(" onchange=\"document.getElementsByName('");
+          stream.print(desc(index)->name);
+          stream.print("')[1].disabled=this.checked;\"");
         }
-        result.print("><input type=\"hidden\" name=\"");
-        result.print(_params[index].name);
-        result.print("\" value=\"");
-        result.print(encodeString(_params[index].editor.checkbox.uncheckedvalue));
-        result.print('"');
-        if (toString(index).equals(_params[index].editor.checkbox.checkedvalue)) {
-          result.print(DISABLED_PSTR);
+        stream.print("><input type=\"hidden\" name=\"");
+        stream.print(desc(index)->name);
+        stream.print("\" value=\"");
+        encodeString(stream, editor.checkbox.uncheckedvalue);
+        stream.print('"');
+        if (checked) {
+          stream.print(DISABLED_PSTR);
         }
-        result.print('>');
+        stream.print('>');
       }
-      if ((_params[index].editor.type == editor_t::EDIT_TEXT) || (_params[index].editor.type == editor_t::EDIT_PASSWORD) ||
-        (_params[index].editor.type == editor_t::EDIT_HIDDEN)) {
-        result.print(" value=\"");
-        toStream(index, result, true);
-        result.print('"');
-        if (_params[index].editor.type == editor_t::EDIT_TEXT) {
-          if (! _params[index].editor.readonly) {
-            if ((_params[index].type >= paraminfo_t::PARAM_I8) && (_params[index].type <= paraminfo_t::PARAM_U32)) { // Integers
-              result.print(" onblur=\"checkInt(this,");
-              if ((_params[index].type == paraminfo_t::PARAM_I8) || (_params[index].type == paraminfo_t::PARAM_I16) ||
-                (_params[index].type == paraminfo_t::PARAM_I32)) {
-                result.printf(FMT_I32_PSTR, _params[index].defvalue.asint);
-              } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf(FMT_U32_PSTR, _params[index].defvalue.asuint);
-              }
-              result.print(',');
-              if ((_params[index].type == paraminfo_t::PARAM_I8) || (_params[index].type == paraminfo_t::PARAM_I16) ||
-                (_params[index].type == paraminfo_t::PARAM_I32)) {
-                result.printf(FMT_I32_PSTR, _params[index].minvalue.asint);
-              } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf(FMT_U32_PSTR, _params[index].minvalue.asuint);
-              }
-              result.print(',');
-              if ((_params[index].type == paraminfo_t::PARAM_I8) || (_params[index].type == paraminfo_t::PARAM_I16) ||
-                (_params[index].type == paraminfo_t::PARAM_I32)) {
-                result.printf(FMT_I32_PSTR, _params[index].maxvalue.asint);
+      if ((editor.type == editor_t::EDIT_TEXT) || (editor.type == editor_t::EDIT_PASSWORD) ||
+        (editor.type == editor_t::EDIT_HIDDEN)) {
+        stream.print(" value=\"");
+        toStream(index, stream, true);
+        stream.print('"');
+        if (editor.type == editor_t::EDIT_TEXT) {
+          if (! editor.readonly) {
+            paraminfo_t::paramtype_t type = desc(index)->type;
+
+            if ((type >= paraminfo_t::PARAM_I8) && (type <= paraminfo_t::PARAM_U32)) { // Integers
+              stream.print(" onblur=\"checkInt(this,");
+              if ((type == paraminfo_t::PARAM_I8) || (type == paraminfo_t::PARAM_I16) ||
+                (type == paraminfo_t::PARAM_I32)) {
+                stream.write((uint8_t*)buf, formatInt(buf, desc(index)->defvalue.asint));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatInt(buf, desc(index)->minvalue.asint));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatInt(buf, desc(index)->maxvalue.asint));
               } else { // type == PARAM_U8 or PARAM_U16 or PARAM_U32
-                result.printf(FMT_U32_PSTR, _params[index].maxvalue.asuint);
-              }
-              result.print(");\"");
-            } else if (_params[index].type == paraminfo_t::PARAM_FLOAT) {
-              result.print(" onblur=\"checkFloat(this,");
-              if (isnan(_params[index].defvalue.asfloat)) {
-                result.print(NAN_PSTR);
-              } else {
-                result.printf(FMT_FLOAT_PSTR, _params[index].defvalue.asfloat);
+                stream.write((uint8_t*)buf, formatUInt(buf, desc(index)->defvalue.asuint));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatUInt(buf, desc(index)->minvalue.asuint));
+                stream.print(',');
+                stream.write((uint8_t*)buf, formatUInt(buf, desc(index)->maxvalue.asuint));
               }
-              result.print(',');
-              if (isnan(_params[index].minvalue.asfloat)) {
-                result.print(NAN_PSTR);
-              } else {
-                result.printf(FMT_FLOAT_PSTR, _params[index].minvalue.asfloat);
-              }
-              result.print(',');
-              if (isnan(_params[index].maxvalue.asfloat)) {
-                result.print(NAN_PSTR);
-              } else {
-                result.printf(FMT_FLOAT_PSTR, _params[index].maxvalue.asfloat);
+              stream.print(");\"");
+            } else if (type == paraminfo_t::PARAM_FLOAT) {
+              const float values[3] = { desc(index)->defvalue.asfloat,
+                desc(index)->minvalue.asfloat, desc(index)->maxvalue.asfloat };
+
+              stream.print(" onblur=\"checkFloat(this");
+              for (uint8_t i = 0; i < 3; ++i) {
+                stream.print(',');
+                if (isnan(values[i]))
+                  stream.print(NAN_PSTR);
+                else
+                  stream.write((uint8_t*)buf, formatFloat(buf, values[i]));
               }
-              result.print(");\"");
+              stream.print(");\"");
             }
           }
         }
-        result.print('>');
+        stream.print('>');
       }
     }
-    return result;
   }
-  return String();
 }
+
 #endif
 
 #ifdef ESP8266
-void Parameters::handleWebPage(ESP8266WebServer &http, const char *restartPath, bool confirmation) {
-  String page;
-
+void Parameters::handleWebPage(ESP8266WebServer &http, const webasset_t *script, const char *restartPath, bool confirmation) {
   if (http.method() == HTTP_GET) {
-    http.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    http.send(200, FPSTR(TEXTHTML_PSTR), FPSTR(EMPTY_PSTR));
-    page = F("<!DOCTYPE html>\n"
+    if (script && http.hasArg(F("js"))) {
+      sendWebAsset(http, *script);
+      return;
+    }
+    WebStream stream(http);
+
+    stream.begin(200, TEXTHTML_PSTR);
+    stream.print(F("<!DOCTYPE html>\n"
       "<html>\n"
       "<head>\n"
       "<title>Parameters</title>\n"
@@ -1175,66 +1304,58 @@ void Parameters::handleWebPage(ESP8266WebServer &http, const char *restartPath,
       "body{background-color:#eee;}\n"
       "tr td:first-child{text-align:right;}\n"
       "textarea{resize:none;}\n"
-      "</style>\n");
-    page.concat(getScript());
-    page.concat(F("</head>\n"
+      "</style>\n"));
+    if (script) {
+      stream.print(F("<script type=\"text/javascript\" src=\""));
+      stream.print(http.uri());
+      stream.print(F("?js\"></script>\n"));
+    } else {
+      stream.print(FPSTR(SCRIPT_PSTR));
+    }
+    stream.print(F("</head>\n"
       "<body>\n"
       "<form action=\"\" method=\"post\">\n"
       "<table cols=2>\n"));
-    http.sendContent(page);
     for (uint16_t i = 0; i < _count; ++i) {
-      if (pgm_read_byte(&_params[i].editor.type) == editor_t::EDIT_NONE)
+      if (editorType(i) == editor_t::EDIT_NONE)
         continue;
-      page = F("<tr><td>");
-      if (pgm_read_ptr(&_params[i].title))
-        page.concat(encodeString((char*)pgm_read_ptr(&_params[i].title)));
+      stream.print(F("<tr><td>"));
+      if (pgm_read_ptr(&desc(i)->title))
+        encodeString(stream, (char*)pgm_read_ptr(&desc(i)->title));
       else
-        page.concat(FPSTR((char*)pgm_read_ptr(&_params[i].name)));
-      page.concat(F("</td><td>"));
-      page.concat(getEditor(i));
-      page.concat(F("</td></tr>\n"));
-      http.sendContent(page);
+        stream.print(FPSTR((char*)pgm_read_ptr(&desc(i)->name)));
+      stream.print(F("</td><td>"));
+      editorToStream(i, stream);
+      stream.print(F("</td></tr>\n"));
     }
-    page = F("</table>\n"
+    stream.print(F("</table>\n"
       "<p>\n"
       "<input type=\"submit\" value=\"Store\">\n"
-      "<input type=\"button\" value=\"Clear\" onclick=\"");
+      "<input type=\"button\" value=\"Clear\" onclick=\""));
     if (confirmation) {
-      page.concat(F("if(confirm('Are you sure to clear parameters?'))"));
+      stream.print(F("if(confirm('Are you sure to clear parameters?'))"));
     }
-    page.concat(F("{openUrl('"));
-    page.concat(http.uri());
-    page.concat(F("','delete');location.reload();}\">\n"));
+    stream.print(F("{openUrl('"));
+    stream.print(http.uri());
+    stream.print(F("','delete');location.reload();}\">\n"));
     if (restartPath) {
-      page.concat(F("<input type=\"button\" value=\"Restart!\" onclick=\""));
+      stream.print(F("<input type=\"button\" value=\"Restart!\" onclick=\""));
       if (confirmation) {
-        page.concat(F("if(confirm('Are you sure to restart?'))"));
+        stream.print(F("if(confirm('Are you sure to restart?'))"));
       }
-      page.concat(F("{location.href='"));
-      page.concat(FPSTR(restartPath));
-      page.concat(F("';}\">\n"));
+      stream.print(F("{location.href='"));
+      stream.print(FPSTR(restartPath));
+      stream.print(F("';}\">\n"));
     }
-    page.concat(F("</form>\n"
+    stream.print(F("</form>\n"
       "</body>\n"
       "</html>\n"));
-    http.sendContent(page);
-    http.sendContent(FPSTR(EMPTY_PSTR));
+    stream.end();
     http.client().stop();
   } else if (http.method() == HTTP_POST) {
     String errors;
+    bool tx = beginTransaction(); // All or nothing
 
-    page = F("<!DOCTYPE html>\n"
-      "<html>\n"
-      "<head>\n"
-      "<title>Store parameters</title>\n"
-      "<style>\n"
-      "body{background-color:#eee;}\n"
-      "</style>\n"
-      "<meta http-equiv=\"refresh\" content=\"5;URL=");
-    page.concat(http.uri());
-    page.concat(F("\">\n"
-      "</head>\n"
-      "<body>\n"));
     for (uint16_t i = 0; i < http.args(); ++i) {
       int16_t param = find(http.argName(i).c_str());
 
@@ -1246,25 +1367,44 @@ void Parameters::handleWebPage(ESP8266WebServer &http, const char *restartPath,
         }
       }
     }
-    if (! update()) {
+    if (tx && (! errors.isEmpty())) {
+      rollback();
+      errors.concat(F("Parameters not changed!\n"));
+    } else if (! (tx ? commit() : flush())) {
       errors.concat(F("Error storing EEPROM parameters!\n"));
     }
+
+    WebStream stream(http);
+
+    stream.begin(errors.isEmpty() ? 200 : 400, TEXTHTML_PSTR);
+    stream.print(F("<!DOCTYPE html>\n"
+      "<html>\n"
+      "<head>\n"
+      "<title>Store parameters</title>\n"
+      "<style>\n"
+      "body{background-color:#eee;}\n"
+      "</style>\n"
+      "<meta http-equiv=\"refresh\" content=\"5;URL="));
+    stream.print(http.uri());
+    stream.print(F("\">\n"
+      "</head>\n"
+      "<body>\n"));
     if (errors.isEmpty()) {
-      page.concat(F("OK\n"));
+      stream.print(F("OK\n"));
     } else {
-      page.concat(F("<span style=\"color:red\">\n"));
-      page.concat(errors);
-      page.concat(F("</span>\n"));
+      stream.print(F("<span style=\"color:red\">\n"));
+      stream.print(errors);
+      stream.print(F("</span>\n"));
     }
-    page.concat(F("<p>\n"
+    stream.print(F("<p>\n"
       "Wait for 5 sec. or click <a href=\""));
-    page.concat(http.uri());
-    page.concat(F("\">this</a> to return to previous page\n"
+    stream.print(http.uri());
+    stream.print(F("\">this</a> to return to previous page\n"
       "</body>\n"
       "</html>\n"));
-    http.send(errors.isEmpty() ? 200 : 400, FPSTR(TEXTHTML_PSTR), page);
+    stream.end();
   } else if (http.method() == HTTP_DELETE) {
-    if (clear()) {
+    if (clear() && flush()) {
       http.send(200, FPSTR(TEXTPLAIN_PSTR), F("OK"));
     } else {
       http.send(400, FPSTR(TEXTPLAIN_PSTR), F("Error clearing EEPROM parameters!"));
@@ -1273,13 +1413,16 @@ void Parameters::handleWebPage(ESP8266WebServer &http, const char *restartPath,
 }
 
 #else
-void Parameters::handleWebPage(WebServer &http, const char *restartPath, bool confirmation) {
-  String page;
-
+void Parameters::handleWebPage(WebServer &http, const webasset_t *script, const char *restartPath, bool confirmation) {
   if (http.method() == HTTP_GET) {
-    http.setContentLength(CONTENT_LENGTH_UNKNOWN);
-    http.send(200, TEXTHTML_PSTR, EMPTY_PSTR);
-    page = "<!DOCTYPE html>\n"
+    if (script && http.hasArg("js")) {
+      sendWebAsset(http, *script);
+      return;
+    }
+    WebStream stream(http);
+
+    stream.begin(200, TEXTHTML_PSTR);
+    stream.print("<!DOCTYPE html>\n"
       "<html>\n"
       "<head>\n"
       "<title>Parameters</title>\n"
@@ -1287,58 +1430,58 @@ void Parameters::handleWebPage(WebServer &http, const char *restartPath, bool co
       "body{background-color:#eee;}\n"
       "tr td:first-child{text-align:right;}\n"
       "textarea{resize:none;}\n"
-      "</style>\n";
-    page.concat(getScript());
-    page.concat("</head>\n"
+      "</style>\n");
+    if (script) {
+      stream.print("<script type=\"text/javascript\" src=\"");
+      stream.print(http.uri());
+      stream.print("?js\"></script>\n");
+    } else {
+      stream.print(SCRIPT_PSTR);
+    }
+    stream.print("</head>\n"
       "<body>\n"
       "<form action=\"\" method=\"post\">\n"
       "<table cols=2>\n");
-    http.sendContent(page);
     for (uint16_t i = 0; i < _count; ++i) {
-      if (_params[i].editor.type == editor_t::EDIT_NONE)
+      if (editorType(i) == editor_t::EDIT_NONE)
         continue;
-      page = "<tr><td>";
-      if (_params[i].title)
-        page.concat(encodeString(_params[i].title));
+      stream.print("<tr><td>");
+      if (desc(i)->title)
+        encodeString(stream, desc(i)->title);
       else
-        page.concat(_params[i].name);
-      page.concat("</td><td>");
-      page.concat(getEditor(i));
-      page.concat("</td></tr>\n");
-      http.sendContent(page);
+        stream.print(desc(i)->name);
+      stream.print("</td><td>");
+      editorToStream(i, stream);
+      stream.print("</td></tr>\n");
     }
-    page = "</table>\n"
+    stream.print("</table>\n"
       "<p>\n"
       "<input type=\"submit\" value=\"Store\">\n"
-      "<input type=\"button\" value=\"Clear\" onclick=\"if(confirm('Are you sure to clear parameters?')){openUrl('";
-    page.concat(http.uri());
-    page.concat("','delete');location.reload();}\">\n");
+      "<input type=\"button\" value=\"Clear\" onclick=\"");
+    if (confirmation) {
+      stream.print("if(confirm('Are you sure to clear parameters?'))");
+    }
+    stream.print("{openUrl('");
+    stream.print(http.uri());
+    stream.print("','delete');location.reload();}\">\n");
     if (restartPath) {
-      page.concat("<input type=\"button\" value=\"Restart!\" onclick=\"if(confirm('Are you sure to restart?')){location.href='");
-      page.concat(restartPath);
-      page.concat("';}\">\n");
+      stream.print("<input type=\"button\" value=\"Restart!\" onclick=\"");
+      if (confirmation) {
+        stream.print("if(confirm('Are you sure to restart?'))");
+      }
+      stream.print("{location.href='");
+      stream.print(restartPath);
+      stream.print("';}\">\n");
     }
-    page.concat("</form>\n"
+    stream.print("</form>\n"
       "</body>\n"
       "</html>\n");
-    http.sendContent(page);
-    http.sendContent(EMPTY_PSTR);
+    stream.end();
     http.client().stop();
   } else if (http.method() == HTTP_POST) {
     String errors;
+    bool tx = beginTransaction(); // All or nothing
 
-    page = "<!DOCTYPE html>\n"
-      "<html>\n"
-      "<head>\n"
-      "<title>Store parameters</title>\n"
-      "<style>\n"
-      "body{background-color:#eee;}\n"
-      "</style>\n"
-      "<meta http-equiv=\"refresh\" content=\"5;URL=";
-    page.concat(http.uri());
-    page.concat("\">\n"
-      "</head>\n"
-      "<body>\n");
     for (uint16_t i = 0; i < http.args(); ++i) {
       int16_t param = find(http.argName(i).c_str());
 
@@ -1350,25 +1493,44 @@ void Parameters::handleWebPage(WebServer &http, const char *restartPath, bool co
         }
       }
     }
-    if (! update()) {
+    if (tx && (! errors.isEmpty())) {
+      rollback();
+      errors.concat("Parameters not changed!\n");
+    } else if (! (tx ? commit() : flush())) {
       errors.concat("Error storing EEPROM parameters!\n");
     }
+
+    WebStream stream(http);
+
+    stream.begin(errors.isEmpty() ? 200 : 400, TEXTHTML_PSTR);
+    stream.print("<!DOCTYPE html>\n"
+      "<html>\n"
+      "<head>\n"
+      "<title>Store parameters</title>\n"
+      "<style>\n"
+      "body{background-color:#eee;}\n"
+      "</style>\n"
+      "<meta http-equiv=\"refresh\" content=\"5;URL=");
+    stream.print(http.uri());
+    stream.print("\">\n"
+      "</head>\n"
+      "<body>\n");
     if (errors.isEmpty()) {
-      page.concat("OK\n");
+      stream.print("OK\n");
     } else {
-      page.concat("<span style=\"color:red\">\n");
-      page.concat(errors);
-      page.concat("</span>\n");
+      stream.print("<span style=\"color:red\">\n");
+      stream.print(errors);
+      stream.print("</span>\n");
     }
-    page.concat("<p>\n"
+    stream.print("<p>\n"
       "Wait for 5 sec. or click <a href=\"");
-    page.concat(http.uri());
-    page.concat("\">this</a> to return to previous page\n"
+    stream.print(http.uri());
+    stream.print("\">this</a> to return to previous page\n"
       "</body>\n"
       "</html>\n");
-    http.send(errors.isEmpty() ? 200 : 400, TEXTHTML_PSTR, page);
+    stream.end();
   } else if (http.method() == HTTP_DELETE) {
-    if (clear()) {
+    if (clear() && flush()) {
       http.send(200, TEXTPLAIN_PSTR, "OK");
     } else {
       http.send(400, TEXTPLAIN_PSTR, "Error clearing EEPROM parameters!");
@@ -1377,149 +1539,737 @@ void Parameters::handleWebPage(WebServer &http, const char *restartPath, bool co
 }
 #endif
 
+bool Parameters::toJson(Stream &stream) {
+  if (! _inited)
+    return false;
+
+  stream.write('{');
+  for (uint16_t i = 0; i < _count; ++i) {
+    const char *str;
+
+    if (i)
+      stream.write(',');
+#ifdef ESP8266
+    str = (char*)pgm_read_ptr(&desc(i)->name);
+    stream.write('"');
+    stream.print(FPSTR(str));
+    stream.write('"');
+#else
+    str = desc(i)->name;
+    JsonTokenizer::escape(stream, str, strlen(str));
+#endif
+    stream.write(':');
+    switch (type(i)) {
+      case paraminfo_t::PARAM_CHAR:
+        JsonTokenizer::escape(stream, (const char*)value(i), 1);
+        break;
+      case paraminfo_t::PARAM_STR:
+        str = (const char*)value(i);
+        JsonTokenizer::escape(stream, str, strlen(str));
+        break;
+      case paraminfo_t::PARAM_BINARY:
+      case paraminfo_t::PARAM_IP:
+        stream.write('"');
+        if (toStream(i, stream) < 0)
+          return false;
+        stream.write('"');
+        break;
+      case paraminfo_t::PARAM_FLOAT:
+        if (! isfinite(*(const float*)value(i))) {
+          stream.print(F("null"));
+          break;
+        }
+        // Fall through
+      default:
+        if (toStream(i, stream) < 0)
+          return false;
+    }
+  }
+  stream.write('}');
+  return true;
+}
+
+/*
+ * Applies flat JSON object ({"name":value,...}) in one transaction, null resets parameter to default
+ */
+bool Parameters::fromJson(const char *json, uint16_t length) {
+  const uint16_t MAX_VALUE = 256;
+
+  JsonTokenizer tokens(json, length);
+  JsonTokenizer::token_t token;
+  bool result;
+
+  if ((tokens.next() != JsonTokenizer::JSON_BEGIN_OBJECT) || (! beginTransaction()))
+    return false;
+  token = tokens.next();
+  result = true;
+  if (token != JsonTokenizer::JSON_END_OBJECT) {
+    while (result) {
+      char value[MAX_VALUE];
+      int16_t index = -1;
+
+      result = (token == JsonTokenizer::JSON_STRING) && (tokens.unescape(value, sizeof(value)) >= 0);
+      if (result) {
+        index = find(value);
+        result = (index >= 0) && (tokens.next() == JsonTokenizer::JSON_COLON);
+      }
+      if (result) {
+        switch (tokens.next()) {
+          case JsonTokenizer::JSON_STRING:
+            if (tokens.tokenLength() < sizeof(value))
+              result = (tokens.unescape(value, sizeof(value)) >= 0) && parse(index, value);
+            else { // Long PARAM_STR or PARAM_BINARY value, unescaped string is never longer than token
+              char *str = new char[tokens.tokenLength() + 1];
+
+              result = str && (tokens.unescape(str, tokens.tokenLength() + 1) >= 0) && parse(index, str);
+              if (str)
+                delete[] str;
+            }
+            break;
+          case JsonTokenizer::JSON_NUMBER:
+          case JsonTokenizer::JSON_TRUE:
+          case JsonTokenizer::JSON_FALSE:
+            result = tokens.tokenLength() < sizeof(value);
+            if (result) {
+              memcpy(value, tokens.token(), tokens.tokenLength());
+              value[tokens.tokenLength()] = '\0';
+              result = parse(index, value);
+            }
+            break;
+          case JsonTokenizer::JSON_NULL:
+            clear(index);
+            break;
+          default:
+            result = false;
+        }
+      }
+      if (result) {
+        token = tokens.next();
+        if (token == JsonTokenizer::JSON_END_OBJECT)
+          break;
+        result = token == JsonTokenizer::JSON_COMMA;
+        token = tokens.next();
+      }
+    }
+  }
+  if (result)
+    result = tokens.next() == JsonTokenizer::JSON_END;
+  if (! result) {
+    rollback();
+    return false;
+  }
+  return commit();
+}
+
+#ifdef ESP8266
+void Parameters::handleJson(ESP8266WebServer &http) {
+  if (http.method() == HTTP_GET) {
+    WebStream stream(http);
+
+    stream.begin(200, APPJSON_PSTR);
+    toJson(stream);
+    stream.end();
+  } else if ((http.method() == HTTP_PATCH) || (http.method() == HTTP_POST)) {
+    const String &body = http.arg(F("plain"));
+
+    if (fromJson(body.c_str(), body.length()))
+      http.send(200, FPSTR(TEXTPLAIN_PSTR), F("OK"));
+    else
+      http.send(400, FPSTR(TEXTPLAIN_PSTR), F("Wrong JSON or parameter value!"));
+  } else {
+    http.send(405, FPSTR(TEXTPLAIN_PSTR), F("Method Not Allowed!"));
+  }
+}
+
+#else
+void Parameters::handleJson(WebServer &http) {
+  if (http.method() == HTTP_GET) {
+    WebStream stream(http);
+
+    stream.begin(200, APPJSON_PSTR);
+    toJson(stream);
+    stream.end();
+  } else if ((http.method() == HTTP_PATCH) || (http.method() == HTTP_POST)) {
+    const String &body = http.arg("plain");
+
+    if (fromJson(body.c_str(), body.length()))
+      http.send(200, TEXTPLAIN_PSTR, "OK");
+    else
+      http.send(400, TEXTPLAIN_PSTR, "Wrong JSON or parameter value!");
+  } else {
+    http.send(405, TEXTPLAIN_PSTR, "Method Not Allowed!");
+  }
+}
+#endif
+
+// CRC-CCITT (polynomial 0x1021) of every byte value
+#ifdef ESP8266
+static const uint16_t CRC16_TABLE[256] PROGMEM = {
+#else
+static const uint16_t CRC16_TABLE[256] = {
+#endif
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+  0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+  0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+  0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+  0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+  0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+  0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+  0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+  0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+  0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+  0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+  0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+  0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+  0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+  0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+  0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+  0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+  0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+  0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+  0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+  0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+  0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+  0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+  0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+  0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+  0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+  0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+  0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+  0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+  0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
 uint16_t Parameters::crc16(uint8_t data, uint16_t crc) {
-  crc ^= data << 8;
-  for (uint8_t i = 0; i < 8; ++i)
-    crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
-  return crc;
+#ifdef ESP8266
+  return (crc << 8) ^ pgm_read_word(&CRC16_TABLE[(crc >> 8) ^ data]);
+#else
+  return (crc << 8) ^ CRC16_TABLE[(crc >> 8) ^ data];
+#endif
 }
 
 uint16_t Parameters::crc16(const uint8_t *data, uint16_t size, uint16_t crc) {
   while (size--) {
-    crc ^= *data++ << 8;
-    for (uint8_t i = 0; i < 8; ++i)
-      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+#ifdef ESP8266
+    crc = (crc << 8) ^ pgm_read_word(&CRC16_TABLE[(crc >> 8) ^ *data++]);
+#else
+    crc = (crc << 8) ^ CRC16_TABLE[(crc >> 8) ^ *data++];
+#endif
   }
   return crc;
 }
 
-void *Parameters::getPtr(uint16_t index) const {
-  void *result = NULL;
-
-  if (_inited && (index < _count)) {
-    result = EEPROM.getDataPtr() + sizeof(header_t);
-    for (uint16_t i = 0; i < index; ++i) {
+int8_t Parameters::compareName(uint16_t index, const char *name) const {
 #ifdef ESP8266
-      result = result + pgm_read_word(&_params[i].size);
+  return strcmp_PP((char*)pgm_read_ptr(&desc(index)->name), name);
 #else
-      result = result + _params[i].size;
+  int result = strcmp(desc(index)->name, name);
+
+  return result < 0 ? -1 : result > 0;
 #endif
+}
+
+/*
+ * Fields are grouped by natural alignment (4, 2, then 1 byte) to read numbers directly from storage,
+ * PARAM_BOOL fields are packed into bitset after them and offsets[] holds the bit number
+ */
+uint16_t Parameters::layout(const dirent_t *dir, uint16_t count, uint16_t *offsets, uint16_t &bitsOffset) {
+  uint16_t result = 0;
+  uint16_t bits = 0;
+
+  for (uint8_t align = 4; align; align >>= 1) {
+    for (uint16_t i = 0; i < count; ++i) {
+      if (paramAlignment(dir[i].type) == align) {
+        offsets[i] = result;
+        result += dir[i].size;
+      }
+    }
+  }
+  bitsOffset = result;
+  for (uint16_t i = 0; i < count; ++i) {
+    if (dir[i].type == paraminfo_t::PARAM_BOOL)
+      offsets[i] = bits++;
+  }
+  return result + (bits + 7) / 8;
+}
+
+/*
+ * Index of the only directory entry with tag and type of entry, -1 if there is none or more than one
+ * (different names with the same CRC can not be told apart)
+ */
+int16_t Parameters::findEntry(const dirent_t *dir, uint16_t count, const dirent_t &entry) {
+  int16_t result = -1;
+
+  for (uint16_t i = 0; i < count; ++i) {
+    if ((dir[i].tag == entry.tag) && (dir[i].type == entry.type)) {
+      if (result >= 0)
+        return -1;
+      result = i;
     }
   }
   return result;
 }
 
+uint16_t Parameters::nameTag(uint16_t index) const {
+#ifdef ESP8266
+  const char *str = (char*)pgm_read_ptr(&desc(index)->name);
+  uint16_t crc = 0xFFFF;
+  char c;
+
+  while ((c = pgm_read_byte(str++)))
+    crc = crc16(c, crc);
+  return crc;
+#else
+  return crc16((uint8_t*)desc(index)->name, strlen(desc(index)->name));
+#endif
+}
+
+void *Parameters::getPtr(uint16_t index) const {
+  if (_inited && (index < _count)) {
+    uint8_t *ptr = getData();
+
+    if (type(index) == paraminfo_t::PARAM_BOOL) // Byte of bitset
+      return ptr + _bitsOffset + _offsets[index] / 8;
+    return ptr + _offsets[index];
+  }
+  return NULL;
+}
+
+bool Parameters::getBit(uint16_t index) const {
+  const uint8_t *bits = getData() + _bitsOffset;
+
+  return (bits[_offsets[index] / 8] >> (_offsets[index] % 8)) & 0x01;
+}
+
+void Parameters::setBit(uint16_t index, bool value) {
+  uint8_t *bits = getData() + _bitsOffset;
+
+  if (value)
+    bits[_offsets[index] / 8] |= (1 << (_offsets[index] % 8));
+  else
+    bits[_offsets[index] / 8] &= ~(1 << (_offsets[index] % 8));
+  markDirty(index);
+}
+
+void Parameters::markDirty(uint16_t index) {
+  uint16_t from, to;
+
+  if (type(index) == paraminfo_t::PARAM_BOOL) {
+    from = _bitsOffset + _offsets[index] / 8;
+    to = from + 1;
+  } else {
+    from = _offsets[index];
+    to = from + size(index);
+  }
+  if (from < _dirtyFrom)
+    _dirtyFrom = from;
+  if (to > _dirtyTo)
+    _dirtyTo = to;
+}
+
+void Parameters::clearDirty() {
+  _dirtyFrom = 0xFFFF;
+  _dirtyTo = 0;
+}
+
+bool Parameters::validate(uint16_t index) const {
+  paraminfo_t::number_t minvalue, maxvalue;
+  const void *ptr = getPtr(index);
+
+#ifdef ESP8266
+  minvalue.asuint = pgm_read_dword(&desc(index)->minvalue.asuint);
+  maxvalue.asuint = pgm_read_dword(&desc(index)->maxvalue.asuint);
+#else
+  minvalue.asuint = desc(index)->minvalue.asuint;
+  maxvalue.asuint = desc(index)->maxvalue.asuint;
+#endif
+  switch (type(index)) {
+    case paraminfo_t::PARAM_I8:
+      return (*(int8_t*)ptr >= minvalue.asint) && (*(int8_t*)ptr <= maxvalue.asint);
+    case paraminfo_t::PARAM_U8:
+      return (*(uint8_t*)ptr >= minvalue.asuint) && (*(uint8_t*)ptr <= maxvalue.asuint);
+    case paraminfo_t::PARAM_I16:
+      return (*(int16_t*)ptr >= minvalue.asint) && (*(int16_t*)ptr <= maxvalue.asint);
+    case paraminfo_t::PARAM_U16:
+      return (*(uint16_t*)ptr >= minvalue.asuint) && (*(uint16_t*)ptr <= maxvalue.asuint);
+    case paraminfo_t::PARAM_I32:
+      return (*(int32_t*)ptr >= minvalue.asint) && (*(int32_t*)ptr <= maxvalue.asint);
+    case paraminfo_t::PARAM_U32:
+      return (*(uint32_t*)ptr >= minvalue.asuint) && (*(uint32_t*)ptr <= maxvalue.asuint);
+    case paraminfo_t::PARAM_FLOAT: // NAN means no limit
+      return (isnan(minvalue.asfloat) || (*(float*)ptr >= minvalue.asfloat)) && (isnan(maxvalue.asfloat) || (*(float*)ptr <= maxvalue.asfloat));
+    default:
+      return true;
+  }
+}
+
 bool Parameters::check() {
   if (_inited) {
-    uint8_t *ptr = EEPROM.getDataPtr();
+    const uint8_t *ptr = _storage->getDataPtr();
     const header_t *header = (header_t*)ptr;
 
-    if (header->sign == EEPROM_SIGN) {
-      uint16_t crc = 0xFFFF;
+    if ((header->sign == EEPROM_SIGN) && (header->schema == _schema) && (header->count == _count) && (header->size == _dataOffset + _dataSize))
+      return crc16(ptr + sizeof(header_t), header->size - sizeof(header_t)) == header->crc;
+  }
+  return false;
+}
 
-      ptr += sizeof(header_t);
-      for (uint16_t i = 0; i < _count; ++i) {
-#ifdef ESP8266
-        crc = crc16(ptr, pgm_read_word(&_params[i].size), crc);
-        ptr += pgm_read_word(&_params[i].size);
-#else
-        crc = crc16(ptr, _params[i].size, crc);
-        ptr += _params[i].size;
+void Parameters::writeDirectory(const dirent_t *dir) {
+  uint8_t *ptr = _storage->getDataPtr();
+
+  ((header_t*)ptr)->sign = 0; // Force store()
+  memset(ptr + sizeof(header_t), 0, _dataOffset - sizeof(header_t));
+  memcpy(ptr + sizeof(header_t), dir, _count * sizeof(dirent_t));
+}
+
+/*
+ * Single pass over stored image: fields are matched by name tag and type, moved to current layout
+ * (strings and binaries are truncated or padded), new fields get default values, removed fields are dropped.
+ * Fields whose tag and type are not unique in current or stored directory get default values too,
+ * otherwise value of one field could silently go to another
+ */
+bool Parameters::migrate(const dirent_t *dir) {
+  uint16_t newSize = _dataOffset + _dataSize;
+  uint8_t *ptr = _storage->getDataPtr();
+  header_t header;
+  const dirent_t *oldDir = dir;
+  uint16_t oldCount = _count;
+  uint16_t oldOffset, oldSize;
+  bool packed = false;
+
+  memcpy(&header, ptr, sizeof(header_t));
+  if (header.sign == EEPROM_SIGN) { // Another schema
+    if ((header.count > 4096) || (header.size < dataOffset(header.count)))
+      return false;
+    if (header.size > newSize) {
+      if (! _storage->begin(header.size))
+        return false;
+      ptr = _storage->getDataPtr();
+    }
+    oldCount = header.count;
+    oldOffset = dataOffset(oldCount);
+    oldSize = header.size;
+  } else if (header.sign == EEPROM_SIGN_ALIGNED) { // Current fields without directory
+    oldOffset = sizeof(uint16_t) * 2;
+    oldSize = oldOffset + _dataSize;
+  } else if (header.sign == EEPROM_SIGN_LEGACY) { // Current fields packed back-to-back in table order
+    oldOffset = sizeof(uint16_t) * 2;
+    oldSize = oldOffset;
+    for (uint16_t i = 0; i < _count; ++i)
+      oldSize += size(i);
+    packed = true;
+  } else
+    return false;
+
+  uint16_t crcOffset = header.sign == EEPROM_SIGN ? sizeof(header_t) : sizeof(uint16_t) * 2;
+
+  if (crc16(ptr + crcOffset, oldSize - crcOffset) != header.crc)
+    return false;
+
+  uint8_t *old = new uint8_t[oldSize];
+  uint16_t *oldOffsets = new uint16_t[oldCount];
+  uint16_t oldBitsOffset = 0;
+
+  if ((! old) || (! oldOffsets)) {
+    if (old)
+      delete[] old;
+    if (oldOffsets)
+      delete[] oldOffsets;
+    return false;
+  }
+  memcpy(old, ptr, oldSize);
+  if (oldSize > newSize) {
+    _storage->end();
+    if (! _storage->begin(newSize)) {
+      delete[] old;
+      delete[] oldOffsets;
+      _inited = false;
+      return false;
+    }
+    ptr = _storage->getDataPtr();
+  }
+  if (header.sign == EEPROM_SIGN)
+    oldDir = (dirent_t*)&old[sizeof(header_t)];
+  if (packed) {
+    uint16_t offset = 0;
+
+    for (uint16_t i = 0; i < oldCount; ++i) {
+      oldOffsets[i] = offset;
+      offset += oldDir[i].size;
+    }
+  } else
+    layout(oldDir, oldCount, oldOffsets, oldBitsOffset);
+
+  writeDirectory(dir);
+  memset(ptr + _dataOffset, 0, _dataSize);
+  for (uint16_t i = 0; i < _count; ++i) {
+    int16_t j = i; // Fields of previous formats are the current ones
+
+    if (oldDir != dir) {
+      if (findEntry(dir, _count, dir[i]) == i)
+        j = findEntry(oldDir, oldCount, dir[i]);
+      else {
+        j = -1;
+#ifdef ESP32
+        ESP_LOGW(TAG, "Parameter \"%s\" has the same tag as another one, not migrated", name(i));
 #endif
       }
-      return crc == header->crc;
     }
+    if (j >= 0) {
+      const uint8_t *src = &old[oldOffset];
+
+      if (dir[i].type == paraminfo_t::PARAM_BOOL) {
+        if (packed)
+          setBit(i, src[oldOffsets[j]]);
+        else
+          setBit(i, (src[oldBitsOffset + oldOffsets[j] / 8] >> (oldOffsets[j] % 8)) & 0x01);
+      } else {
+        uint8_t *dest = (uint8_t*)getPtr(i);
+
+        memcpy(dest, &src[oldOffsets[j]], oldDir[j].size < dir[i].size ? oldDir[j].size : dir[i].size);
+        if (dir[i].type == paraminfo_t::PARAM_STR)
+          dest[dir[i].size - 1] = '\0';
+      }
+    } else
+      clear(i);
   }
-  return false;
+  delete[] old;
+  delete[] oldOffsets;
+  _dirtyFrom = 0;
+  _dirtyTo = _dataSize;
+  return store();
 }
 
 bool Parameters::update() {
   if (! _inited)
     return false;
+  if (_txData) // Stored by commit()
+    return true;
 
-  uint8_t *ptr = EEPROM.getDataPtr();
-  header_t *header = (header_t*)ptr;
-  uint16_t crc = 0xFFFF;
+  if (_commitQuiet || _commitLatency) {
+    if (isDirty() || (((header_t*)_storage->getDataPtr())->sign != EEPROM_SIGN)) {
+      uint32_t now = millis();
 
-  ptr += sizeof(header_t);
-  for (uint16_t i = 0; i < _count; ++i) {
-#ifdef ESP8266
-    crc = crc16(ptr, pgm_read_word(&_params[i].size), crc);
-    ptr += pgm_read_word(&_params[i].size);
-#else
-    crc = crc16(ptr, _params[i].size, crc);
-    ptr += _params[i].size;
+      if (! _pending) {
+        _firstChange = now;
+        _pending = true;
+      }
+      _lastChange = now;
+    }
+    return true;
+  }
+  return store();
+}
+
+bool Parameters::flush() {
+  if ((! _inited) || _txData)
+    return false;
+
+  _pending = false;
+  return store();
+}
+
+bool Parameters::beginTransaction() {
+  if ((! _inited) || _txData)
+    return false;
+
+  _txData = new uint8_t[_dataSize];
+  if (! _txData) {
+#ifdef ESP32
+    ESP_LOGE(TAG, "Error allocating of transaction buffer!");
 #endif
+    return false;
+  }
+  memcpy(_txData, _storage->getDataPtr() + _dataOffset, _dataSize);
+  _txDirtyFrom = _dirtyFrom;
+  _txDirtyTo = _dirtyTo;
+  _txFailed = false;
+  clearDirty();
+  return true;
+}
+
+/*
+ * Validates changed fields and applies all of them with single store() or none
+ */
+bool Parameters::commit() {
+  if (! _txData)
+    return false;
+
+  bool result = ! _txFailed;
+
+  if (result && isDirty()) {
+    const uint8_t *data = _storage->getDataPtr() + _dataOffset;
+
+    for (uint16_t i = 0; i < _count; ++i) {
+      if ((type(i) != paraminfo_t::PARAM_BOOL) && memcmp(&_txData[_offsets[i]], &data[_offsets[i]], size(i)) && (! validate(i))) {
+        result = false;
+        break;
+      }
+    }
+  }
+  if (! result) {
+    rollback();
+    return false;
+  }
+  if (isDirty())
+    memcpy(_storage->getDataPtr() + _dataOffset + _dirtyFrom, &_txData[_dirtyFrom], _dirtyTo - _dirtyFrom);
+  delete[] _txData;
+  _txData = NULL;
+  if (_txDirtyFrom < _dirtyFrom)
+    _dirtyFrom = _txDirtyFrom;
+  if (_txDirtyTo > _dirtyTo)
+    _dirtyTo = _txDirtyTo;
+  return flush();
+}
+
+void Parameters::rollback() {
+  if (_txData) {
+    delete[] _txData;
+    _txData = NULL;
+    _dirtyFrom = _txDirtyFrom;
+    _dirtyTo = _txDirtyTo;
+  }
+}
+
+void Parameters::handle() {
+  if (_pending) {
+    uint32_t now = millis();
+
+    if ((_commitQuiet && (now - _lastChange >= _commitQuiet)) || (_commitLatency && (now - _firstChange >= _commitLatency))) {
+      if (! flush()) { // Retry after next quiet period
+        _firstChange = _lastChange = now;
+        _pending = true;
+      }
+    }
   }
+}
+
+bool Parameters::store() {
+  uint8_t *ptr = _storage->getDataPtr();
+  header_t *header = (header_t*)ptr;
+
+  if ((header->sign == EEPROM_SIGN) && (! isDirty())) // Nothing changed since last check or update
+    return true;
+
+  uint16_t crc = crc16(ptr + sizeof(header_t), _dataOffset - sizeof(header_t) + _dataSize);
+
   if ((header->sign != EEPROM_SIGN) || (header->crc != crc)) {
     header->sign = EEPROM_SIGN;
     header->crc = crc;
-    return EEPROM.commit();
+    header->schema = _schema;
+    header->count = _count;
+    header->size = _dataOffset + _dataSize;
+    if (! _storage->commit())
+      return false;
+    clearDirty();
+    notify();
+    return true;
   }
+  clearDirty();
   return true;
 }
 
-String Parameters::encodeString(char c) {
-  String result;
+bool Parameters::takeSnapshot() {
+  if (! _snapshot) {
+    _snapshot = new uint8_t[_dataSize];
+    if (! _snapshot) {
+#ifdef ESP32
+      ESP_LOGE(TAG, "Error allocating of parameters snapshot!");
+#endif
+      return false;
+    }
+  }
+  memcpy(_snapshot, _storage->getDataPtr() + _dataOffset, _dataSize);
+  return true;
+}
+
+void Parameters::notify() {
+  if ((! _snapshot) || _txData)
+    return;
+
+  const uint8_t *data = _storage->getDataPtr() + _dataOffset;
+
+  for (uint16_t i = 0; i < _count; ++i) {
+    paraminfo_t::paramtype_t t = type(i);
+
+    if (t == paraminfo_t::PARAM_BOOL) {
+      uint16_t offset = _bitsOffset + _offsets[i] / 8;
+      uint8_t mask = 1 << (_offsets[i] % 8);
+
+      if (! ((_snapshot[offset] ^ data[offset]) & mask))
+        continue;
+      _snapshot[offset] ^= mask;
+    } else {
+      uint16_t s = size(i);
+
+      if (! memcmp(&_snapshot[_offsets[i]], &data[_offsets[i]], s))
+        continue;
+      memcpy(&_snapshot[_offsets[i]], &data[_offsets[i]], s); // Before callbacks, so nested update() does not report it again
+    }
+    for (observer_t *observer = _observers; observer; observer = observer->next) {
+      if ((observer->index < 0) || (observer->index == i))
+        observer->callback(i);
+    }
+  }
+}
+
+bool Parameters::onChange(int16_t index, paramobserver_t observer) {
+  if ((index >= _count) || (! observer))
+    return false;
+
+  observer_t *node = new observer_t;
+
+  if (! node) {
+#ifdef ESP32
+    ESP_LOGE(TAG, "Error allocating of parameters observer!");
+#endif
+    return false;
+  }
+  node->callback = observer;
+  node->index = index;
+  node->next = _observers;
+  _observers = node;
+  if (_inited && (! _snapshot))
+    return takeSnapshot();
+  return true;
+}
 
+size_t Parameters::encodeString(Print &print, char c) {
   if (c == '"')
 #ifdef ESP8266
-    result = FPSTR(QUOT_PSTR);
+    return print.print(FPSTR(QUOT_PSTR));
 #else
-    result = QUOT_PSTR;
+    return print.print(QUOT_PSTR);
 #endif
-  else if (c == '<')
+  if (c == '<')
 #ifdef ESP8266
-    result = FPSTR(LT_PSTR);
+    return print.print(FPSTR(LT_PSTR));
 #else
-    result = LT_PSTR;
+    return print.print(LT_PSTR);
 #endif
-  else if (c == '>')
+  if (c == '>')
 #ifdef ESP8266
-    result = FPSTR(GT_PSTR);
+    return print.print(FPSTR(GT_PSTR));
 #else
-    result = GT_PSTR;
+    return print.print(GT_PSTR);
 #endif
-  else
-    result = c;
-  return result;
+  return print.print(c);
 }
 
-String Parameters::encodeString(const char *str) {
-  String result;
+size_t Parameters::encodeString(Print &print, const char *str) {
+  size_t result = 0;
 
   if (str) {
-#ifdef ESP8266
-    uint16_t len = strlen_P(str);
-#else
-    uint16_t len = strlen(str);
-#endif
+    char c;
 
-    if (result.reserve(len)) {
-      for (uint16_t i = 0; i < len; ++i) {
 #ifdef ESP8266
-        char c = pgm_read_byte(&str[i]);
-
-        if (c == '"')
-          result.concat(FPSTR(QUOT_PSTR));
-        else if (c == '<')
-          result.concat(FPSTR(LT_PSTR));
-        else if (c == '>')
-          result.concat(FPSTR(GT_PSTR));
-        else
-          result.concat(c);
+    while ((c = pgm_read_byte(str++))) // Works for RAM and PROGMEM strings
 #else
-        if (str[i] == '"')
-          result.concat(QUOT_PSTR);
-        else if (str[i] == '<')
-          result.concat(LT_PSTR);
-        else if (str[i] == '>')
-          result.concat(GT_PSTR);
-        else
-          result.concat(str[i]);
+    while ((c = *str++))
 #endif
-      }
-    }
+      result += encodeString(print, c);
   }
   return result;
 }
@@ -1552,7 +2302,7 @@ static uint8_t findFreeChannel() {
   return result + 1;
 }
 
-bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd, uint16_t duration, cpcallback_t callback) {
+bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd, uint16_t duration, cpcallback_t callback, const webasset_t *script) {
 #ifdef ESP8266
   static const char SLASH_PSTR[] PROGMEM = "/";
   static const char RESTART_PSTR[] PROGMEM = "/restart";
@@ -1668,18 +2418,18 @@ bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd,
   });
 #ifdef ESP8266
   http->on(FPSTR(SLASH_PSTR), [&]() {
-    params->handleWebPage(*http, RESTART_PSTR);
+    params->handleWebPage(*http, script, RESTART_PSTR);
 #else
   http->on(SLASH_PSTR, [&]() {
-    params->handleWebPage(*http, RESTART_PSTR);
+    params->handleWebPage(*http, script, RESTART_PSTR);
 #endif
   });
 #ifdef ESP8266
   http->on(FPSTR(GENERATE204_PSTR), [&]() {
-    params->handleWebPage(*http, RESTART_PSTR, false);
+    params->handleWebPage(*http, script, RESTART_PSTR, false);
 #else
   http->on(GENERATE204_PSTR, [&]() {
-    params->handleWebPage(*http, RESTART_PSTR, false);
+    params->handleWebPage(*http, script, RESTART_PSTR, false);
 #endif
   });
 #ifdef ESP8266
@@ -1714,6 +2464,7 @@ bool paramsCaptivePortal(Parameters *params, const char *ssid, const char *pswd,
       "</html>");
 #endif
     http->client().stop();
+    params->flush();
     if (callback) {
       callback(CP_RESTART, NULL);
     }
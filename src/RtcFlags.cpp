@@ -1,3 +1,4 @@
+#include <coredecls.h>
 #include "RtcFlags.h"
 
 uint16_t RtcFlags::getFlags() {
@@ -29,3 +30,34 @@ bool RtcFlags::setFlag(uint8_t flag) {
 bool RtcFlags::clearFlag(uint8_t flag) {
   return setFlags(getFlags() & ~(1 << flag));
 }
+
+RtcStore::data_t RtcStore::_data;
+bool RtcStore::_dirty = false;
+
+bool RtcStore::begin() {
+  _dirty = false;
+  if (ESP.rtcUserMemoryRead(OFFSET, (uint32_t*)&_data, sizeof(_data))) {
+    if (crc32(&_data.mask, sizeof(_data) - sizeof(_data.crc)) == _data.crc)
+      return true;
+  }
+  memset(&_data, 0, sizeof(_data));
+  return false;
+}
+
+void RtcStore::clear(uint8_t slot) {
+  if (has(slot)) {
+    _data.mask &= ~(1 << slot);
+    _data.slots[slot] = 0;
+    _dirty = true;
+  }
+}
+
+bool RtcStore::commit() {
+  if (_dirty) {
+    _data.crc = crc32(&_data.mask, sizeof(_data) - sizeof(_data.crc));
+    if (! ESP.rtcUserMemoryWrite(OFFSET, (uint32_t*)&_data, sizeof(_data)))
+      return false;
+    _dirty = false;
+  }
+  return true;
+}
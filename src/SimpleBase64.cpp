@@ -2,6 +2,7 @@
 #include <pgmspace.h>
 #endif
 #include "SimpleBase64.h"
+#include "StrUtils.h"
 
 static bool isBase64(char c) {
   return ((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z')) || ((c >= '0') && (c <= '9')) || (c == '+') || (c == '/');
@@ -191,13 +192,18 @@ int16_t decodeBase64(Stream &stream, uint8_t *data, uint16_t maxsize) {
   uint32_t buffer = 0;
   uint8_t buflen = 0;
 
-  while (stream.available() && maxsize) {
-    char c = stream.read();
+  bool padding = false;
+  char c;
 
+  while (readLineChar(stream, c)) { // Whole line is consumed, even after padding or when data is full
     if (c == '=')
-      break;
-    if (! isBase64(c))
+      padding = true;
+    if (padding || (! maxsize))
+      continue;
+    if (! isBase64(c)) {
+      skipLine(stream);
       return -1;
+    }
     buffer |= decodeByte(c) << ((3 - buflen) * 6);
     if (++buflen >= 4) {
       for (int8_t i = 2; i >= 0; --i) {
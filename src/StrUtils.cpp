@@ -1,5 +1,8 @@
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
 #include "StrUtils.h"
 
 String printfToString(const char *fmt, ...) {
@@ -34,16 +37,260 @@ int8_t strncmp_PP(const char *s1, const char *s2, uint16_t maxlen) {
   return c1 - c2;
 }
 
-int sscanf_P(const char *str, const char *fmt, ...) {
-  va_list vargs;
-  int result;
-  char _str[strlen_P(str) + 1];
-  char _fmt[strlen_P(fmt) + 1];
+bool readLineChar(Stream &stream, char &c) {
+  if (! stream.readBytes(&c, 1)) // Waits for next char up to stream timeout
+    return false;
+  if (c == '\r') {
+    if (stream.peek() == '\n')
+      stream.read();
+    return false;
+  }
+  return c != '\n';
+}
 
-  strcpy_P(_str, str);
-  strcpy_P(_fmt, fmt);
-  va_start(vargs, fmt);
-  result = vsscanf(_str, _fmt, vargs);
-  va_end(vargs);
+void skipLine(Stream &stream) {
+  char c;
+
+  while (readLineChar(stream, c)) {}
+}
+
+static const char *skipSpaces(const char *str) {
+  while ((*str == ' ') || (*str == '\t'))
+    ++str;
+  return str;
+}
+
+static bool parseDigits(const char *&str, uint32_t &value, uint32_t maxvalue) {
+  uint32_t result = 0;
+
+  if ((*str < '0') || (*str > '9'))
+    return false;
+  do {
+    uint8_t digit = *str++ - '0';
+
+    if ((digit > maxvalue) || (result > (maxvalue - digit) / 10)) // Overflow
+      return false;
+    result = result * 10 + digit;
+  } while ((*str >= '0') && (*str <= '9'));
+  value = result;
+  return true;
+}
+
+bool parseInt(const char *str, int32_t &value, int32_t minvalue, int32_t maxvalue) {
+  bool negative = false;
+  uint32_t result;
+
+  str = skipSpaces(str);
+  if ((*str == '-') || (*str == '+'))
+    negative = *str++ == '-';
+  if (negative) {
+    if (! parseDigits(str, result, minvalue < 0 ? 0 - (uint32_t)minvalue : 0))
+      return false;
+  } else {
+    if ((maxvalue < 0) || (! parseDigits(str, result, maxvalue)))
+      return false;
+  }
+  if (*skipSpaces(str))
+    return false;
+  value = negative ? (int32_t)(0 - result) : (int32_t)result;
+  return (value >= minvalue) && (value <= maxvalue);
+}
+
+bool parseUInt(const char *str, uint32_t &value, uint32_t maxvalue) {
+  uint32_t result;
+
+  str = skipSpaces(str);
+  if (*str == '+')
+    ++str;
+  if ((! parseDigits(str, result, maxvalue)) || *skipSpaces(str))
+    return false;
+  value = result;
+  return true;
+}
+
+bool parseFloat(const char *str, float &value) {
+  char *end;
+  float result;
+
+  str = skipSpaces(str);
+  if (! *str)
+    return false;
+  result = strtof(str, &end);
+  if ((end == str) || *skipSpaces(end))
+    return false;
+  value = result;
+  return true;
+}
+
+bool parseIP(const char *str, uint8_t *ip) {
+  uint8_t result[4];
+
+  str = skipSpaces(str);
+  for (uint8_t i = 0; i < 4; ++i) {
+    uint32_t octet;
+
+    if (i && (*str++ != '.'))
+      return false;
+    if (! parseDigits(str, octet, 255))
+      return false;
+    result[i] = octet;
+  }
+  if (*skipSpaces(str))
+    return false;
+  memcpy(ip, result, sizeof(result));
+  return true;
+}
+
+static const char DIGIT_PAIRS[200] PROGMEM = {
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+uint8_t formatUInt(char *buf, uint32_t value) {
+  char digits[10];
+  uint8_t pos = sizeof(digits);
+
+  while (value >= 100) { // Two digits per division
+    uint8_t pair = value % 100;
+
+    value /= 100;
+    pos -= 2;
+    digits[pos] = pgm_read_byte(&DIGIT_PAIRS[pair * 2]);
+    digits[pos + 1] = pgm_read_byte(&DIGIT_PAIRS[pair * 2 + 1]);
+  }
+  if (value >= 10) {
+    pos -= 2;
+    digits[pos] = pgm_read_byte(&DIGIT_PAIRS[value * 2]);
+    digits[pos + 1] = pgm_read_byte(&DIGIT_PAIRS[value * 2 + 1]);
+  } else
+    digits[--pos] = '0' + value;
+  memcpy(buf, &digits[pos], sizeof(digits) - pos);
+  buf[sizeof(digits) - pos] = '\0';
+  return sizeof(digits) - pos;
+}
+
+uint8_t formatInt(char *buf, int32_t value) {
+  if (value < 0) {
+    *buf = '-';
+    return formatUInt(buf + 1, 0 - (uint32_t)value) + 1;
+  }
+  return formatUInt(buf, value);
+}
+
+static double power10(uint8_t exp) {
+  double result = 1;
+
+  while (exp--)
+    result *= 10;
   return result;
 }
+
+static float scaled(uint32_t mantissa, int8_t exp) {
+  if (exp < 0) // Division by exact power of 10 keeps rounding error minimal
+    return (double)mantissa / power10(-exp);
+  return (double)mantissa * power10(exp);
+}
+
+uint8_t formatFloat(char *buf, float value) {
+  char *ptr = buf;
+
+  if (isnan(value)) {
+    strcpy_P(buf, PSTR("nan"));
+    return 3;
+  }
+  if (signbit(value)) {
+    *ptr++ = '-';
+    value = -value;
+  }
+  if (isinf(value)) {
+    strcpy_P(ptr, PSTR("inf"));
+    return ptr - buf + 3;
+  }
+  if (value == 0) {
+    strcpy_P(ptr, PSTR("0"));
+    return ptr - buf + 1;
+  }
+
+  int8_t exp10 = floor(log10(value));
+  uint32_t mantissa = 0;
+
+  if (exp10 < 0 ? value * power10(-exp10) < 1 : value < power10(exp10))
+    --exp10;
+  uint8_t precision;
+
+  // Find the least number of significant digits that reads back to the same float (9 digits are always enough)
+  for (precision = 1; precision <= 9; ++precision) {
+    int8_t exp = exp10 - precision + 1;
+    double m = exp < 0 ? value * power10(-exp) : value / power10(exp);
+
+    mantissa = m + 0.5;
+    if (mantissa >= (uint32_t)power10(precision)) { // Rounded up to next decade
+      mantissa /= 10;
+      if (scaled(mantissa, exp + 1) == value) {
+        ++exp10;
+        break;
+      }
+      continue;
+    }
+    if (scaled(mantissa, exp) == value)
+      break;
+  }
+  if (precision > 9)
+    precision = 9;
+  while ((precision > 1) && (! (mantissa % 10))) {
+    mantissa /= 10;
+    --precision;
+  }
+
+  char digits[10];
+
+  formatUInt(digits, mantissa);
+  if ((exp10 >= -5) && (exp10 < 9)) { // Plain notation
+    if (exp10 < 0) {
+      *ptr++ = '0';
+      *ptr++ = '.';
+      for (int8_t i = exp10 + 1; i < 0; ++i)
+        *ptr++ = '0';
+      memcpy(ptr, digits, precision);
+      ptr += precision;
+    } else {
+      for (uint8_t i = 0; i <= exp10; ++i)
+        *ptr++ = i < precision ? digits[i] : '0';
+      if (precision > exp10 + 1) {
+        *ptr++ = '.';
+        memcpy(ptr, &digits[exp10 + 1], precision - exp10 - 1);
+        ptr += precision - exp10 - 1;
+      }
+    }
+  } else { // Scientific notation
+    *ptr++ = digits[0];
+    if (precision > 1) {
+      *ptr++ = '.';
+      memcpy(ptr, &digits[1], precision - 1);
+      ptr += precision - 1;
+    }
+    *ptr++ = 'e';
+    ptr += formatInt(ptr, exp10);
+  }
+  *ptr = '\0';
+  return ptr - buf;
+}
+
+uint8_t formatIP(char *buf, const uint8_t *ip) {
+  char *ptr = buf;
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (i)
+      *ptr++ = '.';
+    ptr += formatUInt(ptr, ip[i]);
+  }
+  return ptr - buf;
+}
@@ -0,0 +1,118 @@
+#include <string.h>
+#ifdef ESP32
+#include <esp_log.h>
+#endif
+#include "WebStream.h"
+
+#ifdef ESP32
+static const char TAG[] = "WebStream";
+#endif
+
+bool WebStream::begin(int code, const char *type) {
+  if (_active)
+    return false;
+
+#ifdef ESP8266
+  _chunked = _http.chunkedResponseModeStart_P(code, type);
+  if (! _chunked) { // HTTP/1.0 client, content until connection closed
+    _http.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    _http.send_P(code, type, PSTR(""));
+  }
+#else
+  _http.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  _http.send(code, type, "");
+  _chunked = false; // WebServer frames chunks itself
+#endif
+  _buffer = new uint8_t[HEAD_SIZE + BUFFER_SIZE + TAIL_SIZE];
+  if (! _buffer) { // Unbuffered, but still working
+#ifdef ESP32
+    ESP_LOGW(TAG, "Error allocating of response buffer!");
+#endif
+  }
+  _length = 0;
+  _active = true;
+  return true;
+}
+
+void WebStream::end() {
+  if (_active) {
+    flush();
+#ifdef ESP8266
+    if (_chunked)
+      _http.chunkedResponseFinalize();
+#else
+    _http.sendContent("");
+#endif
+    if (_buffer) {
+      delete[] _buffer;
+      _buffer = NULL;
+    }
+    _active = false;
+  }
+}
+
+size_t WebStream::write(const uint8_t *buffer, size_t size) {
+  if (! _active)
+    return 0;
+
+  size_t result = size;
+
+  if (! _buffer) {
+    while (size) {
+      uint16_t len = size > BUFFER_SIZE ? BUFFER_SIZE : size;
+
+      sendChunk(buffer, len);
+      buffer += len;
+      size -= len;
+    }
+    return result;
+  }
+  while (size) {
+    size_t len = BUFFER_SIZE - _length;
+
+    if (len > size)
+      len = size;
+    memcpy(&_buffer[HEAD_SIZE + _length], buffer, len);
+    _length += len;
+    buffer += len;
+    size -= len;
+    if (_length >= BUFFER_SIZE)
+      flush();
+  }
+  return result;
+}
+
+void WebStream::flush() {
+  if (_active && _buffer && _length) {
+    sendChunk(&_buffer[HEAD_SIZE], _length);
+    _length = 0;
+  }
+}
+
+void WebStream::sendChunk(const uint8_t *data, uint16_t size) {
+#ifdef ESP8266
+  if (_buffer && (data == &_buffer[HEAD_SIZE])) {
+    uint8_t *start = &_buffer[HEAD_SIZE];
+    uint16_t len = size;
+
+    if (_chunked) { // Size in hex and CRLF before data, CRLF after
+      *--start = '\n';
+      *--start = '\r';
+      do {
+        uint8_t digit = len & 0x0F;
+
+        *--start = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        len >>= 4;
+      } while (len);
+      _buffer[HEAD_SIZE + size] = '\r';
+      _buffer[HEAD_SIZE + size + 1] = '\n';
+      size += TAIL_SIZE;
+    }
+    _http.client().write(start, &_buffer[HEAD_SIZE] - start + size);
+  } else {
+    _http.sendContent((const char*)data, size);
+  }
+#else
+  _http.sendContent((const char*)data, size);
+#endif
+}
@@ -4,7 +4,14 @@
 #include <ESP8266SSDP.h>
 #include <PubSubClient.h>
 #include "Parameters.h"
+#include "ParamJournal.h"
+#include "ParamSlots.h"
 #include "RtcFlags.h"
+#include "RtcParam.h"
+#include "WebAssets.h"
+
+extern "C" uint32_t _FS_start;
+extern "C" uint32_t _FS_end;
 
 const uint8_t RELAY_PIN = 0;
 const bool RELAY_LEVEL = HIGH;
@@ -14,43 +21,55 @@ const bool LED_LEVEL = LOW;
 
 const uint32_t LED_PULSE = 25; // 25 ms.
 
+const bool PARAMS_SLOTS = false; // Parameters in two alternating sectors instead of journal over all file system area
+
+const uint8_t RTC_RELAY_STATE = 0; // RtcStore slot
+const uint32_t RELAY_PERSIST_DELAY = 60000; // 1 min. of unchanged relay state before it is written to flash
+
+const uint8_t EVENT_LISTENERS = 4; // Simultaneous SSE or long polling clients
+const uint32_t EVENT_KEEPALIVE = 30000; // 30 sec.
+const uint32_t POLL_TIMEOUT = 25000; // 25 sec.
+
+const uint32_t COMMIT_QUIET = 2000; // 2 sec.
+const uint32_t COMMIT_LATENCY = 30000; // 30 sec.
+
 const char CP_SSID[] PROGMEM = "ESP01_Relay";
 const char CP_PSWD[] PROGMEM = "1029384756";
 
-const char PARAM_WIFI_SSID_NAME[] PROGMEM = "wifi_ssid";
-const char PARAM_WIFI_SSID_TITLE[] PROGMEM = "WiFi SSID";
-const char PARAM_WIFI_PSWD_NAME[] PROGMEM = "wifi_pswd";
-const char PARAM_WIFI_PSWD_TITLE[] PROGMEM = "WiFi password";
-const char PARAM_MQTT_SERVER_NAME[] PROGMEM = "mqtt_server";
-const char PARAM_MQTT_SERVER_TITLE[] PROGMEM = "MQTT broker";
-const char PARAM_MQTT_PORT_NAME[] PROGMEM = "mqtt_port";
-const char PARAM_MQTT_PORT_TITLE[] PROGMEM = "MQTT port";
-const uint16_t PARAM_MQTT_PORT_DEF = 1883;
-const char PARAM_MQTT_CLIENT_NAME[] PROGMEM = "mqtt_client";
-const char PARAM_MQTT_CLIENT_TITLE[] PROGMEM = "MQTT client";
-const char PARAM_MQTT_CLIENT_DEF[] PROGMEM = "ESP01_Relay";
-const char PARAM_MQTT_USER_NAME[] PROGMEM = "mqtt_user";
-const char PARAM_MQTT_USER_TITLE[] PROGMEM = "MQTT user";
-const char PARAM_MQTT_PSWD_NAME[] PROGMEM = "mqtt_pswd";
-const char PARAM_MQTT_PSWD_TITLE[] PROGMEM = "MQTT password";
-const char PARAM_MQTT_TOPIC_NAME[] PROGMEM = "mqtt_topic";
-const char PARAM_MQTT_TOPIC_TITLE[] PROGMEM = "MQTT topic";
-const char PARAM_MQTT_TOPIC_DEF[] PROGMEM = "/Relay";
-const char PARAM_MQTT_RETAINED_NAME[] PROGMEM = "mqtt_retain";
-const char PARAM_MQTT_RETAINED_TITLE[] PROGMEM = "MQTT retained";
-const bool PARAM_MQTT_RETAINED_DEF = false;
-const char PARAM_BOOT_STATE_NAME[] PROGMEM = "boot_state";
-const char PARAM_BOOT_STATE_TITLE[] PROGMEM = "Relay state on boot";
-const bool PARAM_BOOT_STATE_DEF = false;
-const char PARAM_PERSISTENT_NAME[] PROGMEM = "persist";
-const char PARAM_PERSISTENT_TITLE[] PROGMEM = "Persistent relay state";
-const bool PARAM_PERSISTENT_DEF = false;
+constexpr char PARAM_WIFI_SSID_NAME[] PROGMEM = "wifi_ssid";
+constexpr char PARAM_WIFI_SSID_TITLE[] PROGMEM = "WiFi SSID";
+constexpr char PARAM_WIFI_PSWD_NAME[] PROGMEM = "wifi_pswd";
+constexpr char PARAM_WIFI_PSWD_TITLE[] PROGMEM = "WiFi password";
+constexpr char PARAM_MQTT_SERVER_NAME[] PROGMEM = "mqtt_server";
+constexpr char PARAM_MQTT_SERVER_TITLE[] PROGMEM = "MQTT broker";
+constexpr char PARAM_MQTT_PORT_NAME[] PROGMEM = "mqtt_port";
+constexpr char PARAM_MQTT_PORT_TITLE[] PROGMEM = "MQTT port";
+constexpr uint16_t PARAM_MQTT_PORT_DEF = 1883;
+constexpr char PARAM_MQTT_CLIENT_NAME[] PROGMEM = "mqtt_client";
+constexpr char PARAM_MQTT_CLIENT_TITLE[] PROGMEM = "MQTT client";
+constexpr char PARAM_MQTT_CLIENT_DEF[] PROGMEM = "ESP01_Relay";
+constexpr char PARAM_MQTT_USER_NAME[] PROGMEM = "mqtt_user";
+constexpr char PARAM_MQTT_USER_TITLE[] PROGMEM = "MQTT user";
+constexpr char PARAM_MQTT_PSWD_NAME[] PROGMEM = "mqtt_pswd";
+constexpr char PARAM_MQTT_PSWD_TITLE[] PROGMEM = "MQTT password";
+constexpr char PARAM_MQTT_TOPIC_NAME[] PROGMEM = "mqtt_topic";
+constexpr char PARAM_MQTT_TOPIC_TITLE[] PROGMEM = "MQTT topic";
+constexpr char PARAM_MQTT_TOPIC_DEF[] PROGMEM = "/Relay";
+constexpr char PARAM_MQTT_RETAINED_NAME[] PROGMEM = "mqtt_retain";
+constexpr char PARAM_MQTT_RETAINED_TITLE[] PROGMEM = "MQTT retained";
+constexpr bool PARAM_MQTT_RETAINED_DEF = false;
+constexpr char PARAM_BOOT_STATE_NAME[] PROGMEM = "boot_state";
+constexpr char PARAM_BOOT_STATE_TITLE[] PROGMEM = "Relay state on boot";
+constexpr bool PARAM_BOOT_STATE_DEF = false;
+constexpr char PARAM_PERSISTENT_NAME[] PROGMEM = "persist";
+constexpr char PARAM_PERSISTENT_TITLE[] PROGMEM = "Persistent relay state";
+constexpr bool PARAM_PERSISTENT_DEF = false;
 
 const char OFF_PSTR[] PROGMEM = "OFF";
 const char ON_PSTR[] PROGMEM = "ON";
 const char *const STATES[] PROGMEM = { OFF_PSTR, ON_PSTR };
 
-const paraminfo_t PARAMS[] PROGMEM = {
+constexpr paraminfo_t PARAMS[] PROGMEM = {
   PARAM_STR(PARAM_WIFI_SSID_NAME, PARAM_WIFI_SSID_TITLE, 33, NULL),
   PARAM_PASSWORD(PARAM_WIFI_PSWD_NAME, PARAM_WIFI_PSWD_TITLE, 33, NULL),
   PARAM_STR(PARAM_MQTT_SERVER_NAME, PARAM_MQTT_SERVER_TITLE, 33, NULL),
@@ -64,13 +83,54 @@ const paraminfo_t PARAMS[] PROGMEM = {
   PARAM_BOOL(PARAM_PERSISTENT_NAME, PARAM_PERSISTENT_TITLE, PARAM_PERSISTENT_DEF)
 };
 
+PARAMS_LAYOUT(PARAMS_LAYOUT, PARAMS);
+PARAMS_SCHEMA(PARAMS_SCHEMA, PARAMS); // Only compact schema is kept in flash, not PARAMS table
+
+constexpr paramkey_t<const char*, 0> PARAM_WIFI_SSID;
+constexpr paramkey_t<const char*, 1> PARAM_WIFI_PSWD;
+constexpr paramkey_t<const char*, 2> PARAM_MQTT_SERVER;
+constexpr paramkey_t<uint16_t, 3> PARAM_MQTT_PORT;
+constexpr paramkey_t<const char*, 4> PARAM_MQTT_CLIENT;
+constexpr paramkey_t<const char*, 5> PARAM_MQTT_USER;
+constexpr paramkey_t<const char*, 6> PARAM_MQTT_PSWD;
+constexpr paramkey_t<const char*, 7> PARAM_MQTT_TOPIC;
+constexpr paramkey_t<bool, 8> PARAM_MQTT_RETAINED;
+constexpr paramkey_t<bool, 9> PARAM_BOOT_STATE;
+constexpr paramkey_t<bool, 10> PARAM_PERSISTENT;
+
+static_assert(paramKeyValid(PARAMS, PARAM_WIFI_SSID, PARAM_WIFI_SSID_NAME), "Wrong PARAM_WIFI_SSID key!");
+static_assert(paramKeyValid(PARAMS, PARAM_WIFI_PSWD, PARAM_WIFI_PSWD_NAME), "Wrong PARAM_WIFI_PSWD key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_SERVER, PARAM_MQTT_SERVER_NAME), "Wrong PARAM_MQTT_SERVER key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_PORT, PARAM_MQTT_PORT_NAME), "Wrong PARAM_MQTT_PORT key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_CLIENT, PARAM_MQTT_CLIENT_NAME), "Wrong PARAM_MQTT_CLIENT key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_USER, PARAM_MQTT_USER_NAME), "Wrong PARAM_MQTT_USER key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_PSWD, PARAM_MQTT_PSWD_NAME), "Wrong PARAM_MQTT_PSWD key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_TOPIC, PARAM_MQTT_TOPIC_NAME), "Wrong PARAM_MQTT_TOPIC key!");
+static_assert(paramKeyValid(PARAMS, PARAM_MQTT_RETAINED, PARAM_MQTT_RETAINED_NAME), "Wrong PARAM_MQTT_RETAINED key!");
+static_assert(paramKeyValid(PARAMS, PARAM_BOOT_STATE, PARAM_BOOT_STATE_NAME), "Wrong PARAM_BOOT_STATE key!");
+static_assert(paramKeyValid(PARAMS, PARAM_PERSISTENT, PARAM_PERSISTENT_NAME), "Wrong PARAM_PERSISTENT key!");
+
 Parameters *params = NULL;
+RtcParam<bool> *persistentState = NULL;
 ESP8266WebServer *http = NULL;
 WiFiClient *client = NULL;
 PubSubClient *mqtt = NULL;
 bool relayState;
+bool wifiChanged = false, mqttChanged = false; // Set by parameters observers, applied in loop()
+
+struct listener_t {
+  WiFiClient client;
+  uint32_t time; // Last event sent (SSE) or request received (long polling)
+  bool stream; // Server-Sent Events, otherwise long polling
+};
+
+listener_t listeners[EVENT_LISTENERS];
 
 static void halt(const char *msg = NULL) {
+  if (persistentState)
+    persistentState->save();
+  if (params)
+    params->flush();
   if (msg)
     Serial.println(FPSTR(msg));
   Serial.flush();
@@ -78,25 +138,100 @@ static void halt(const char *msg = NULL) {
 }
 
 static void restart(const char *msg = NULL) {
+  if (persistentState)
+    persistentState->save();
+  if (params)
+    params->flush();
   if (msg)
     Serial.println(FPSTR(msg));
   Serial.flush();
   ESP.restart();
 }
 
+static listener_t *addListener(bool stream) {
+  for (uint8_t i = 0; i < EVENT_LISTENERS; ++i) {
+    if (! listeners[i].client.connected()) {
+      listeners[i].client = http->client(); // Keeps connection open after handler returns
+      listeners[i].client.setNoDelay(true);
+      listeners[i].time = millis();
+      listeners[i].stream = stream;
+      return &listeners[i];
+    }
+  }
+  return NULL;
+}
+
+static void sendState(listener_t &listener) {
+  char json[sizeof("{\"state\":false}")];
+
+  strcpy_P(json, PSTR("{\"state\":"));
+  strcat_P(json, BOOLS[relayState]);
+  strcat_P(json, PSTR("}"));
+  if (listener.stream) {
+    listener.client.print(F("data: "));
+    listener.client.print(json);
+    if (listener.client.print(F("\n\n")) == 2)
+      listener.time = millis();
+    else
+      listener.client.stop();
+  } else {
+    listener.client.print(F("HTTP/1.1 200 OK\r\n"
+      "Content-Type: text/json\r\n"
+      "Cache-Control: no-cache\r\n"
+      "Connection: close\r\n"
+      "Content-Length: "));
+    listener.client.print((unsigned int)strlen(json));
+    listener.client.print(F("\r\n\r\n"));
+    listener.client.print(json);
+    listener.client.stop();
+  }
+}
+
+static void notifyListeners() {
+  for (uint8_t i = 0; i < EVENT_LISTENERS; ++i) {
+    if (listeners[i].client.connected())
+      sendState(listeners[i]);
+  }
+}
+
+static void handleListeners() {
+  for (uint8_t i = 0; i < EVENT_LISTENERS; ++i) {
+    if (listeners[i].client.connected()) {
+      if (listeners[i].stream) {
+        if (millis() - listeners[i].time >= EVENT_KEEPALIVE) {
+          if (listeners[i].client.print(F(":\n\n")) == 3) // Comment to detect dead connection
+            listeners[i].time = millis();
+          else
+            listeners[i].client.stop();
+        }
+      } else if (millis() - listeners[i].time >= POLL_TIMEOUT) {
+        sendState(listeners[i]); // Unchanged
+      }
+    }
+  }
+}
+
 static void relaySwitch(bool on, bool publish = false) {
+  bool changed = on != relayState;
+
   digitalWrite(RELAY_PIN, on == RELAY_LEVEL);
   if (publish && mqtt && mqtt->connected()) {
     char value;
 
     value = '0' + on;
-    mqtt->publish((char*)params->value(PARAM_MQTT_TOPIC_NAME), (uint8_t*)&value, 1, *(bool*)params->value(PARAM_MQTT_RETAINED_NAME));
+    mqtt->publish(params->value(PARAM_MQTT_TOPIC), (uint8_t*)&value, 1, params->value(PARAM_MQTT_RETAINED));
   }
   relayState = on;
-  if (*(bool*)params->value(PARAM_PERSISTENT_NAME)) {
-    params->set(PARAM_BOOT_STATE_NAME, &relayState);
-    params->update();
-  }
+  if (params->value(PARAM_PERSISTENT))
+    persistentState->set(relayState); // RTC memory in next loop(), flash only when state is stable
+  if (changed)
+    notifyListeners();
+}
+
+static bool bootState() {
+  if (params->value(PARAM_PERSISTENT))
+    return persistentState->get();
+  return params->value(PARAM_BOOT_STATE);
 }
 
 static void httpPageNotFound() {
@@ -104,80 +239,31 @@ static void httpPageNotFound() {
 }
 
 static void httpRootPage() {
-  String page;
+  sendWebAsset(*http, WEB_INDEX_HTML);
+}
 
-  page = F("<!DOCTYPE html>\n"
-    "<html>\n"
-    "<head>\n"
-    "<title>ESP01-Relay</title>\n"
-    "<style>\n"
-    "body{background-color:#eee;}\n"
-    ".checkbox{vertical-align:top;margin:0 3px 0 0;width:17px;height:17px;}\n"
-    ".checkbox+label{cursor:pointer;}\n"
-    ".checkbox:not(checked){position:absolute;opacity:0;}\n"
-    ".checkbox:not(checked)+label{position:relative;padding:0 0 0 60px;}\n"
-    ".checkbox:not(checked)+label:before{content:'';position:absolute;top:-4px;left:0;width:50px;height:26px;border-radius:13px;background:#CDD1DA;box-shadow:inset 0 2px 3px rgba(0,0,0,.2);}\n"
-    ".checkbox:not(checked)+label:after{content:'';position:absolute;top:-2px;left:2px;width:22px;height:22px;border-radius:10px;background:#FFF;box-shadow:0 2px 5px rgba(0,0,0,.3);transition:all .2s;}\n"
-    ".checkbox:checked+label:before{background:#9FD468;}\n"
-    ".checkbox:checked+label:after{left:26px;}\n"
-    "</style>\n"
-    "<script type=\"text/javascript\">\n"
-    "function getXmlHttpRequest(){\n"
-    "let x;\n"
-    "try{\n"
-    "x=new ActiveXObject(\"Msxml2.XMLHTTP\");\n"
-    "}catch(e){\n"
-    "try{\n"
-    "x=newActiveXObject(\"Microsoft.XMLHTTP\");\n"
-    "}catch(E){\n"
-    "x=false;\n"
-    "}\n"
-    "}\n"
-    "if((!x)&&(typeof XMLHttpRequest!='undefined')){\n"
-    "x=new XMLHttpRequest();\n"
-    "}\n"
-    "return x;\n"
-    "}\n"
-    "function openUrl(u,m){\n"
-    "let x=getXmlHttpRequest();\n"
-    "x.open(m,u,false);\n"
-    "x.send(null);\n"
-    "if(x.status!=200){\n"
-    "//alert(x.responseText);\n"
-    "return false;\n"
-    "}\n"
-    "return true;\n"
-    "}\n"
-    "function refreshData(){\n"
-    "let request=getXmlHttpRequest();\n"
-    "request.open('GET','/switch?dummy='+Date.now(),true);\n"
-    "request.onreadystatechange=function(){\n"
-    "if((request.readyState==4)&&(request.status==200)){\n"
-    "let data=JSON.parse(request.responseText);\n"
-    "document.getElementById('relay').checked=data.state;\n"
-    "}\n"
-    "}\n"
-    "request.send(null);\n"
-    "}\n"
-    "setInterval(refreshData,500);\n"
-    "</script>\n"
-    "</head>\n"
-    "<body>\n"
-    "<input type=\"checkbox\" class=\"checkbox\" name=\"relay\" id=\"relay\" onchange=\"openUrl('/switch?on='+this.checked+'&dummy='+Date.now(),'post');\"");
-  if (relayState)
-    page.concat(F(" checked"));
-  page.concat(F(">\n"
-    "<label for=\"relay\">Relay</label>\n"
-    "<p>\n"
-    "<button onclick=\"location.href='/setup'\">Setup</button>\n"
-    "<button onclick=\"if(confirm('Are you sure to restart?')){location.href='/restart';}\">Restart!</button>\n"
-    "</body>\n"
-    "</html>"));
-  http->send(200, F("text/html"), page);
+static void httpEventsPage() {
+  listener_t *listener = addListener(true);
+
+  if (! listener) {
+    http->send_P(503, PSTR("text/plain"), PSTR("Too many listeners!"));
+    return;
+  }
+  listener->client.print(F("HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"));
+  sendState(*listener); // Initial state
 }
 
 static void httpSwitchPage() {
   if (http->method() == HTTP_GET) {
+    if (http->hasArg(F("wait")) && http->arg(F("wait")).equals(FPSTR(BOOLS[relayState]))) {
+      if (addListener(false))
+        return; // Answered by relaySwitch() or after POLL_TIMEOUT by handleListeners()
+    }
+
     String page = F("{\"state\":");
 
     page.concat(FPSTR(BOOLS[relayState]));
@@ -218,17 +304,63 @@ static void httpRestartPage() {
   restart(PSTR("Restarting..."));
 }
 
+static void mqttSetup() {
+  if (mqtt && mqtt->connected())
+    mqtt->disconnect();
+  if (*params->value(PARAM_MQTT_SERVER) && *params->value(PARAM_MQTT_CLIENT) && *params->value(PARAM_MQTT_TOPIC)) {
+    if (! mqtt) {
+      client = new WiFiClient();
+      if (! client)
+        halt(PSTR("WiFi client creation FAIL!"));
+      mqtt = new PubSubClient(*client);
+      if (! mqtt)
+        halt(PSTR("MQTT initialization FAIL!"));
+      mqtt->setCallback([&](char *topic, uint8_t *payload, unsigned int length) {
+        if (! strcmp(topic, params->value(PARAM_MQTT_TOPIC))) {
+          if ((length == 1) && (*payload >= '0') && (*payload <= '1')) {
+            relaySwitch(*payload - '0');
+          }
+        }
+      });
+    }
+    mqtt->setServer(params->value(PARAM_MQTT_SERVER), params->value(PARAM_MQTT_PORT)); // Reconnect and subscribe in loop()
+  } else if (mqtt) {
+    delete mqtt;
+    mqtt = NULL;
+    delete client;
+    client = NULL;
+  }
+}
+
 void setup() {
   WiFi.persistent(false);
 
   Serial.begin(115200);
   Serial.println();
 
-  params = new Parameters(PARAMS, ARRAY_SIZE(PARAMS));
+  {
+    uint32_t sector = ((uint32_t)&_FS_start - 0x40200000) / SPI_FLASH_SEC_SIZE;
+    uint32_t sectors = ((uint32_t)&_FS_end - (uint32_t)&_FS_start) / SPI_FLASH_SEC_SIZE;
+    ParamStorage *storage = NULL;
+
+    if (PARAMS_SLOTS) {
+      if (sectors >= ParamSlots::SECTORS) // First sectors of unused file system area hold parameters
+        storage = new ParamSlots(sector, new EEPROMStorage());
+    } else if (sectors >= ParamJournal::MIN_SECTORS) { // Unused file system area holds parameters journal
+      storage = new ParamJournal(sector, sectors > 255 ? 255 : sectors, new EEPROMStorage());
+    }
+    params = new Parameters(PARAMS_SCHEMA, PARAMS_LAYOUT, storage);
+  }
   if ((! params) || (! params->begin()))
     halt(PSTR("Initialization of parameters FAIL!"));
+  params->setCommitDelay(COMMIT_QUIET, COMMIT_LATENCY);
+  RtcStore::begin();
+  persistentState = new RtcParam<bool>(*params, PARAM_BOOT_STATE, RTC_RELAY_STATE, RELAY_PERSIST_DELAY);
+  if (! persistentState)
+    halt(PSTR("Initialization of persistent state FAIL!"));
+  persistentState->begin(params->value(PARAM_PERSISTENT));
 
-  relayState = *(bool*)params->value(PARAM_BOOT_STATE_NAME);
+  relayState = bootState();
 
   pinMode(RELAY_PIN, OUTPUT);
   digitalWrite(RELAY_PIN, relayState == RELAY_LEVEL);
@@ -236,7 +368,7 @@ void setup() {
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, ! LED_LEVEL);
 
-  bool paramIncomplete = (! *(char*)params->value(PARAM_WIFI_SSID_NAME)) || (! *(char*)params->value(PARAM_WIFI_PSWD_NAME));
+  bool paramIncomplete = (! *params->value(PARAM_WIFI_SSID)) || (! *params->value(PARAM_WIFI_PSWD));
 
   if (paramIncomplete || ((ESP.getResetInfoPtr()->reason != REASON_SOFT_RESTART) && (! RtcFlags::getFlag(0)))) {
     RtcFlags::setFlag(0);
@@ -266,25 +398,34 @@ void setup() {
         default:
           break;
       }
-    }))
+    }, &WEB_PARAMS_JS))
     halt(PSTR("Captive portal FAIL!"));
 
-    relayState = *(bool*)params->value(PARAM_BOOT_STATE_NAME);
+    relayState = bootState();
     digitalWrite(RELAY_PIN, relayState == RELAY_LEVEL);
   }
   RtcFlags::clearFlag(0);
-  if ((! *(char*)params->value(PARAM_WIFI_SSID_NAME)) || (! *(char*)params->value(PARAM_WIFI_PSWD_NAME)))
+  if ((! *params->value(PARAM_WIFI_SSID)) || (! *params->value(PARAM_WIFI_PSWD)))
     restart(PSTR("Parameters incomplete!"));
 
   http = new ESP8266WebServer();
   if (! http)
     halt(PSTR("Web server initialization FAIL!"));
+  {
+    static const char *headers[] = { "If-None-Match" };
+
+    http->collectHeaders(headers, ARRAY_SIZE(headers));
+  }
   http->onNotFound(httpPageNotFound);
   http->on(F("/"), HTTP_GET, httpRootPage);
   http->on(F("/index.html"), HTTP_GET, httpRootPage);
   http->on(F("/switch"), httpSwitchPage);
+  http->on(F("/events"), HTTP_GET, httpEventsPage);
   http->on(F("/setup"), [&]() {
-    params->handleWebPage(*http);
+    params->handleWebPage(*http, &WEB_PARAMS_JS);
+  });
+  http->on(F("/params.json"), [&]() {
+    params->handleJson(*http);
   });
   http->on(F("/restart"), HTTP_GET, httpRestartPage);
   http->on(F("/description.xml"), HTTP_GET, [&]() {
@@ -301,26 +442,19 @@ void setup() {
   SSDP.setManufacturer(F("NoName Ltd."));
   SSDP.setDeviceType(F("upnp:rootdevice"));
 
-  if (*(char*)params->value(PARAM_MQTT_SERVER_NAME) && *(char*)params->value(PARAM_MQTT_CLIENT_NAME) && *(char*)params->value(PARAM_MQTT_TOPIC_NAME)) {
-    client = new WiFiClient();
-    if (! client)
-      halt(PSTR("WiFi client creation FAIL!"));
-    mqtt = new PubSubClient(*client);
-    if (! mqtt)
-      halt(PSTR("MQTT initialization FAIL!"));
-    mqtt->setServer((char*)params->value(PARAM_MQTT_SERVER_NAME), *(uint16_t*)params->value(PARAM_MQTT_PORT_NAME));
-    mqtt->setCallback([&](char *topic, uint8_t *payload, unsigned int length) {
-      if (! strcmp(topic, (char*)params->value(PARAM_MQTT_TOPIC_NAME))) {
-        if ((length == 1) && (*payload >= '0') && (*payload <= '1')) {
-          relaySwitch(*payload - '0');
-        }
-      }
-    });
-  }
+  mqttSetup();
+  params->onChange(-1, [&](uint16_t index) {
+    if ((index == PARAM_WIFI_SSID.index) || (index == PARAM_WIFI_PSWD.index))
+      wifiChanged = true;
+    else if ((index >= PARAM_MQTT_SERVER.index) && (index <= PARAM_MQTT_TOPIC.index))
+      mqttChanged = true;
+    else if (index == PARAM_BOOT_STATE.index) // Changed on /setup page, must not be overridden by RTC memory
+      persistentState->reload();
+  });
 
   WiFi.mode(WIFI_STA);
   {
-    const char *name = (char*)params->value(PARAM_MQTT_CLIENT_NAME);
+    const char *name = params->value(PARAM_MQTT_CLIENT);
 
     if (*name) {
       if (! WiFi.hostname(name)) {
@@ -339,6 +473,24 @@ void loop() {
   static uint32_t lastWiFiTry = 0;
   static uint32_t lastMqttTry = 0;
 
+  persistentState->handle();
+  params->handle();
+
+  if (wifiChanged) {
+    wifiChanged = false;
+    if (WiFi.isConnected()) {
+      Serial.println(F("WiFi parameters changed"));
+      WiFi.disconnect(); // Reconnect with new credentials below
+    }
+    lastWiFiTry = 0;
+  }
+  if (mqttChanged) {
+    mqttChanged = false;
+    Serial.println(F("MQTT parameters changed"));
+    mqttSetup();
+    lastMqttTry = 0;
+  }
+
   if (! WiFi.isConnected()) {
     if ((! lastWiFiTry) || (millis() - lastWiFiTry >= WIFI_TIMEOUT)) {
       uint32_t start;
@@ -347,8 +499,8 @@ void loop() {
       {
         const char *ssid;
 
-        ssid = (char*)params->value(PARAM_WIFI_SSID_NAME);
-        WiFi.begin(ssid, (char*)params->value(PARAM_WIFI_PSWD_NAME));
+        ssid = params->value(PARAM_WIFI_SSID);
+        WiFi.begin(ssid, params->value(PARAM_WIFI_PSWD));
         Serial.print(F("Connecting to SSID \""));
         Serial.print(ssid);
         Serial.print('"');
@@ -376,26 +528,27 @@ void loop() {
     }
   } else {
     http->handleClient();
+    handleListeners();
     if (mqtt) {
       if (! mqtt->connected()) {
         if ((! lastMqttTry) || (millis() - lastMqttTry >= MQTT_TIMEOUT)) {
           const char *user, *pswd;
           bool connected;
 
-          user = (char*)params->value(PARAM_MQTT_USER_NAME);
-          pswd = (char*)params->value(PARAM_MQTT_PSWD_NAME);
+          user = params->value(PARAM_MQTT_USER);
+          pswd = params->value(PARAM_MQTT_PSWD);
           digitalWrite(LED_PIN, LED_LEVEL);
           Serial.print(F("Connecting to MQTT broker \""));
-          Serial.print((char*)params->value(PARAM_MQTT_SERVER_NAME));
+          Serial.print(params->value(PARAM_MQTT_SERVER));
           Serial.print(F("\"... "));
           if (*user && *pswd)
-            connected = mqtt->connect((char*)params->value(PARAM_MQTT_CLIENT_NAME), user, pswd);
+            connected = mqtt->connect(params->value(PARAM_MQTT_CLIENT), user, pswd);
           else
-            connected = mqtt->connect((char*)params->value(PARAM_MQTT_CLIENT_NAME));
+            connected = mqtt->connect(params->value(PARAM_MQTT_CLIENT));
           digitalWrite(LED_PIN, ! LED_LEVEL);
           if (connected) {
             Serial.println(F("OK"));
-            mqtt->subscribe((char*)params->value(PARAM_MQTT_TOPIC_NAME));
+            mqtt->subscribe(params->value(PARAM_MQTT_TOPIC));
             lastMqttTry = 0;
           } else {
             Serial.println(F("FAIL!"));
@@ -0,0 +1,353 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <Arduino.h>
+#include <coredecls.h>
+#include <EEPROM.h>
+#include <ESP8266WiFi.h>
+
+EspClass ESP;
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+ESP8266WiFiClass WiFi;
+
+static unsigned long clockShift = 0; // Accumulated by delay()
+
+static uint64_t clockMicros() {
+  using namespace std::chrono;
+
+  return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+unsigned long millis() {
+  return clockMicros() / 1000 + clockShift;
+}
+
+unsigned long micros() {
+  return clockMicros() + clockShift * 1000;
+}
+
+void delay(unsigned long ms) {
+  clockShift += ms;
+}
+
+void yield() {}
+
+static uint8_t pins[17];
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin < sizeof(pins))
+    pins[pin] = value;
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < sizeof(pins) ? pins[pin] : LOW;
+}
+
+uint32_t crc32(const void *data, size_t length, uint32_t crc) {
+  const uint8_t *ptr = (const uint8_t*)data;
+
+  while (length--) {
+    crc ^= *ptr++;
+    for (uint8_t i = 0; i < 8; ++i)
+      crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+  }
+  return crc;
+}
+
+/*
+ * EspClass
+ */
+
+static std::vector<uint8_t> flashMemory(EspClass::FLASH_SIZE, 0xFF);
+static std::vector<uint32_t> sectorErases(EspClass::FLASH_SIZE / SPI_FLASH_SEC_SIZE, 0);
+static uint32_t writtenBytes = 0;
+static int32_t flashBudget = -1;
+static uint32_t rtcMemory[EspClass::RTC_USER_SIZE / sizeof(uint32_t)];
+static uint32_t rtcWriteCount = 0;
+static rst_info resetInfo = { REASON_DEFAULT_RST };
+
+bool EspClass::flashEraseSector(uint32_t sector) {
+  if ((sector >= sectorErases.size()) || (! flashBudget))
+    return false;
+  memset(&flashMemory[sector * SPI_FLASH_SEC_SIZE], 0xFF, SPI_FLASH_SEC_SIZE);
+  ++sectorErases[sector];
+  return true;
+}
+
+bool EspClass::flashWrite(uint32_t address, const uint32_t *data, size_t size) {
+  if ((address & 0x03) || (size & 0x03) || (address + size > FLASH_SIZE))
+    return false;
+  for (size_t i = 0; i < size; ++i) {
+    if (! flashBudget)
+      return false;
+    if (flashBudget > 0)
+      --flashBudget;
+    flashMemory[address + i] &= ((const uint8_t*)data)[i]; // NOR flash clears bits only
+    ++writtenBytes;
+  }
+  return true;
+}
+
+bool EspClass::flashRead(uint32_t address, uint32_t *data, size_t size) {
+  if ((address & 0x03) || (address + size > FLASH_SIZE))
+    return false;
+  memcpy(data, &flashMemory[address], size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size) {
+  if (offset * sizeof(uint32_t) + size > RTC_USER_SIZE)
+    return false;
+  memcpy(data, &rtcMemory[offset], size);
+  return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size) {
+  if (offset * sizeof(uint32_t) + size > RTC_USER_SIZE)
+    return false;
+  memcpy(&rtcMemory[offset], data, size);
+  ++rtcWriteCount;
+  return true;
+}
+
+void EspClass::restart() {
+  resetInfo.reason = REASON_SOFT_RESTART;
+}
+
+void EspClass::deepSleep(uint64_t time) {
+  (void)time;
+  resetInfo.reason = REASON_DEEP_SLEEP_AWAKE;
+}
+
+rst_info *EspClass::getResetInfoPtr() {
+  return &resetInfo;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return 40960;
+}
+
+void EspClass::flashClear() {
+  std::fill(flashMemory.begin(), flashMemory.end(), 0xFF);
+  std::fill(sectorErases.begin(), sectorErases.end(), 0);
+  writtenBytes = 0;
+  flashBudget = -1;
+}
+
+uint32_t EspClass::flashErases(uint32_t sector) const {
+  return sector < ::sectorErases.size() ? sectorErases[sector] : 0;
+}
+
+uint32_t EspClass::flashWritten() const {
+  return writtenBytes;
+}
+
+void EspClass::flashFailAfter(int32_t bytes) {
+  flashBudget = bytes;
+}
+
+void EspClass::rtcClear() {
+  for (uint16_t i = 0; i < sizeof(rtcMemory) / sizeof(rtcMemory[0]); ++i)
+    rtcMemory[i] = i * 0x9E3779B9; // Not erased, just random
+  rtcWriteCount = 0;
+  resetInfo.reason = REASON_DEFAULT_RST;
+}
+
+uint32_t EspClass::rtcWrites() const {
+  return rtcWriteCount;
+}
+
+/*
+ * EEPROMClass
+ */
+
+void EEPROMClass::begin(size_t size) {
+  size = (size + 3) & ~3;
+  if (size > SPI_FLASH_SEC_SIZE)
+    size = SPI_FLASH_SEC_SIZE;
+  if (_data)
+    delete[] _data;
+  _data = new uint8_t[size];
+  _size = size;
+  ESP.flashRead(SECTOR * SPI_FLASH_SEC_SIZE, (uint32_t*)_data, _size);
+}
+
+bool EEPROMClass::end() {
+  bool result = commit();
+
+  if (_data) {
+    delete[] _data;
+    _data = NULL;
+  }
+  _size = 0;
+  return result;
+}
+
+bool EEPROMClass::commit() { // Like the core, rewrites the whole sector when anything changed
+  if (! _data)
+    return false;
+
+  uint8_t *image = new uint8_t[_size];
+  bool result = ESP.flashRead(SECTOR * SPI_FLASH_SEC_SIZE, (uint32_t*)image, _size);
+
+  if (result && memcmp(image, _data, _size))
+    result = ESP.flashEraseSector(SECTOR) && ESP.flashWrite(SECTOR * SPI_FLASH_SEC_SIZE, (const uint32_t*)_data, _size);
+  delete[] image;
+  return result;
+}
+
+uint8_t *EEPROMClass::getDataPtr() {
+  return _data;
+}
+
+/*
+ * HardwareSerial
+ */
+
+void HardwareSerial::begin(unsigned long baud) {
+  (void)baud;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+/*
+ * String
+ */
+
+String::String(long value, uint8_t base) {
+  if (value < 0) {
+    _str = "-";
+    _str += String((unsigned long)-value, base)._str;
+  } else {
+    _str = String((unsigned long)value, base)._str;
+  }
+}
+
+String::String(unsigned long value, uint8_t base) {
+  char str[sizeof(value) * 8 + 1];
+  char *ptr = &str[sizeof(str) - 1];
+
+  *ptr = '\0';
+  do {
+    uint8_t digit = value % base;
+
+    *--ptr = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  _str = ptr;
+}
+
+String::String(double value, uint8_t digits) {
+  char str[33];
+
+  snprintf(str, sizeof(str), "%.*f", digits, value);
+  _str = str;
+}
+
+/*
+ * Print
+ */
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t result = 0;
+
+  while (size--)
+    result += write(*buffer++);
+  return result;
+}
+
+size_t Print::print(long value, int base) {
+  return print(String(value, base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return print(String(value, base));
+}
+
+size_t Print::print(double value, int digits) {
+  return print(String(value, digits));
+}
+
+size_t Print::printf(const char *format, ...) {
+  va_list args;
+  char *str = NULL;
+
+  va_start(args, format);
+  int len = vasprintf(&str, format, args);
+  va_end(args);
+  if (len < 0)
+    return 0;
+
+  size_t result = write((const uint8_t*)str, len);
+
+  free(str);
+  return result;
+}
+
+size_t Print::printf_P(PGM_P format, ...) {
+  va_list args;
+  char *str = NULL;
+
+  va_start(args, format);
+  int len = vasprintf(&str, format, args);
+  va_end(args);
+  if (len < 0)
+    return 0;
+
+  size_t result = write((const uint8_t*)str, len);
+
+  free(str);
+  return result;
+}
+
+/*
+ * Stream
+ */
+
+int Stream::timedRead() {
+  return read();
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t result = 0;
+
+  while (result < length) {
+    int c = timedRead();
+
+    if (c < 0)
+      break;
+    buffer[result++] = c;
+  }
+  return result;
+}
+
+String Stream::readString() {
+  String result;
+  int c;
+
+  while ((c = timedRead()) >= 0)
+    result.concat((char)c);
+  return result;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String result;
+  int c;
+
+  while (((c = timedRead()) >= 0) && (c != terminator))
+    result.concat((char)c);
+  return result;
+}
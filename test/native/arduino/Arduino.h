@@ -0,0 +1,90 @@
+#pragma once
+
+/*
+ * Minimal ESP8266 Arduino core emulation for host builds of the library, tests and benchmarks.
+ * Flash and RTC user memory are kept in RAM, flash erases are counted per sector.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include "pgmspace.h"
+#include "WString.h"
+#include "Stream.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x00
+#define OUTPUT 0x01
+
+#define SPI_FLASH_SEC_SIZE 4096
+#define FLASH_SECTOR_SIZE SPI_FLASH_SEC_SIZE
+
+typedef bool boolean;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms); // Advances emulated clock without sleeping
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+enum rst_reason { REASON_DEFAULT_RST, REASON_WDT_RST, REASON_EXCEPTION_RST, REASON_SOFT_WDT_RST, REASON_SOFT_RESTART,
+  REASON_DEEP_SLEEP_AWAKE, REASON_EXT_SYS_RST };
+
+struct rst_info {
+  uint32_t reason;
+};
+
+class EspClass {
+public:
+  static const uint32_t FLASH_SIZE = 1048576; // 1 MB
+  static const uint16_t RTC_USER_SIZE = 512; // Bytes of RTC user memory
+
+  bool flashEraseSector(uint32_t sector);
+  bool flashWrite(uint32_t address, const uint32_t *data, size_t size);
+  bool flashRead(uint32_t address, uint32_t *data, size_t size);
+
+  bool rtcUserMemoryRead(uint32_t offset, uint32_t *data, size_t size);
+  bool rtcUserMemoryWrite(uint32_t offset, uint32_t *data, size_t size);
+
+  void restart();
+  void deepSleep(uint64_t time);
+  rst_info *getResetInfoPtr();
+  uint32_t getFreeHeap();
+
+  // Host emulation only
+  void flashClear(); // Erased state of the whole flash, counters reset
+  uint32_t flashErases(uint32_t sector) const;
+  uint32_t flashWritten() const; // Total bytes written
+  void flashFailAfter(int32_t bytes); // Power loss: writes stop after so many more bytes, -1 to disable
+  void rtcClear(); // Power on state of RTC memory (garbage)
+  uint32_t rtcWrites() const; // Calls of rtcUserMemoryWrite() since rtcClear()
+};
+
+extern EspClass ESP;
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+};
+
+extern HardwareSerial Serial;
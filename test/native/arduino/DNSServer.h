@@ -0,0 +1,15 @@
+#pragma once
+
+#include "ESP8266WiFi.h"
+
+enum class DNSReplyCode { NoError, FormError, ServerFailure, NonExistentDomain };
+
+class DNSServer {
+public:
+  void setErrorReplyCode(DNSReplyCode) {}
+  bool start(uint16_t, const String&, const IPAddress&) {
+    return true;
+  }
+  void stop() {}
+  void processNextRequest() {}
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+  void begin(size_t size);
+  bool end();
+  bool commit();
+  uint8_t *getDataPtr();
+  const uint8_t *getConstDataPtr() const {
+    return _data;
+  }
+  size_t length() const {
+    return _size;
+  }
+
+  static const uint32_t SECTOR = EspClass::FLASH_SIZE / SPI_FLASH_SEC_SIZE - 5; // As in 1 MB flash layouts
+
+protected:
+  uint8_t *_data = NULL;
+  size_t _size = 0;
+};
+
+extern EEPROMClass EEPROM;
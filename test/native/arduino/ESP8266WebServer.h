@@ -0,0 +1,183 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include "ESP8266WiFi.h"
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+/*
+ * Host stub of web server: request is set by request(), whole response (status line, headers and content)
+ * is collected in client().output()
+ */
+class ESP8266WebServer {
+public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  ESP8266WebServer(int port = 80) {
+    (void)port;
+  }
+
+  void begin() {}
+  void handleClient() {}
+  void onNotFound(THandlerFunction) {}
+  void on(const String&, THandlerFunction) {}
+  void on(const String&, HTTPMethod, THandlerFunction) {}
+  void collectHeaders(const char *headers[], size_t count) {
+    (void)headers;
+    (void)count;
+  }
+
+  // Host emulation only
+  void request(HTTPMethod method, const String &uri) {
+    _method = method;
+    _uri = uri;
+    _args.clear();
+    _headers.clear();
+    _client = WiFiClient();
+  }
+  void addArg(const String &name, const String &value) {
+    _args.push_back(std::make_pair(name, value));
+  }
+  void addHeader(const String &name, const String &value) {
+    _headers.push_back(std::make_pair(name, value));
+  }
+
+  HTTPMethod method() const {
+    return _method;
+  }
+  const String &uri() const {
+    return _uri;
+  }
+  String hostHeader() const {
+    return header("Host");
+  }
+  int args() const {
+    return _args.size();
+  }
+  String argName(int i) const {
+    return (i >= 0) && (i < args()) ? _args[i].first : String();
+  }
+  String arg(int i) const {
+    return (i >= 0) && (i < args()) ? _args[i].second : String();
+  }
+  String arg(const String &name) const {
+    for (size_t i = 0; i < _args.size(); ++i) {
+      if (_args[i].first == name)
+        return _args[i].second;
+    }
+    return String();
+  }
+  bool hasArg(const String &name) const {
+    for (size_t i = 0; i < _args.size(); ++i) {
+      if (_args[i].first == name)
+        return true;
+    }
+    return false;
+  }
+  String header(const String &name) const {
+    for (size_t i = 0; i < _headers.size(); ++i) {
+      if (_headers[i].first == name)
+        return _headers[i].second;
+    }
+    return String();
+  }
+  bool hasHeader(const String &name) const {
+    return ! header(name).isEmpty();
+  }
+
+  WiFiClient &client() {
+    return _client;
+  }
+
+  void setContentLength(size_t length) {
+    _contentLength = length;
+  }
+  void sendHeader(const String &name, const String &value, bool first = false) {
+    String line = name + ": " + value + "\r\n";
+
+    if (first)
+      _responseHeaders = line + _responseHeaders;
+    else
+      _responseHeaders.concat(line);
+  }
+  void send(int code, const char *type = NULL, const String &content = String()) {
+    sendHead(code, type, content.length());
+    sendContent(content);
+  }
+  void send(int code, const __FlashStringHelper *type, const String &content = String()) {
+    send(code, (const char*)type, content);
+  }
+  void send(int code, const String &type, const String &content) {
+    send(code, type.c_str(), content);
+  }
+  void send_P(int code, PGM_P type, PGM_P content) {
+    send(code, type, String(content));
+  }
+  void send_P(int code, PGM_P type, PGM_P content, size_t length) {
+    sendHead(code, type, length);
+    sendContent(content, length);
+  }
+  bool chunkedResponseModeStart_P(int code, PGM_P type) {
+    sendHeader("Transfer-Encoding", "chunked");
+    sendHead(code, type, CONTENT_LENGTH_UNKNOWN);
+    _chunked = true;
+    return true;
+  }
+  void chunkedResponseFinalize() {
+    _client.write("0\r\n\r\n");
+    _chunked = false;
+  }
+  void sendContent(const String &content) {
+    sendContent(content.c_str(), content.length());
+  }
+  void sendContent(const char *content, size_t length) {
+    if (_chunked) {
+      _client.print(String((unsigned long)length, HEX));
+      _client.write("\r\n");
+    }
+    _client.write(content, length);
+    if (_chunked)
+      _client.write("\r\n");
+  }
+  void sendContent_P(PGM_P content) {
+    sendContent(content, strlen_P(content));
+  }
+  void sendContent_P(PGM_P content, size_t length) {
+    sendContent(content, length);
+  }
+
+protected:
+  void sendHead(int code, const char *type, size_t length) {
+    if (_contentLength != CONTENT_LENGTH_UNKNOWN)
+      _contentLength = length;
+    _client.print("HTTP/1.1 ");
+    _client.print(code);
+    _client.write("\r\n");
+    if (type) {
+      _client.print("Content-Type: ");
+      _client.print(type);
+      _client.write("\r\n");
+    }
+    if (_contentLength != CONTENT_LENGTH_UNKNOWN) {
+      _client.print("Content-Length: ");
+      _client.print((unsigned long)_contentLength);
+      _client.write("\r\n");
+    }
+    _client.print(_responseHeaders);
+    _client.write("\r\n");
+    _responseHeaders = String();
+    _contentLength = 0;
+  }
+
+  std::vector<std::pair<String, String>> _args;
+  std::vector<std::pair<String, String>> _headers;
+  String _uri;
+  String _responseHeaders;
+  WiFiClient _client;
+  size_t _contentLength = 0;
+  HTTPMethod _method = HTTP_GET;
+  bool _chunked = false;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "WiFiClient.h"
+
+enum WiFiMode_t { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA };
+
+/*
+ * Host stub of WiFi, no networks and no stations
+ */
+class ESP8266WiFiClass {
+public:
+  void persistent(bool) {}
+  bool mode(WiFiMode_t) {
+    return true;
+  }
+  bool disconnect(bool = false) {
+    return true;
+  }
+  int8_t scanNetworks(bool = false, bool = false) {
+    return 0;
+  }
+  void scanDelete() {}
+  int32_t channel(uint8_t) {
+    return 1;
+  }
+  int32_t RSSI(uint8_t) {
+    return 0;
+  }
+  bool begin(const char*, const char* = NULL) {
+    return true;
+  }
+  bool isConnected() {
+    return false;
+  }
+  bool reconnect() {
+    return true;
+  }
+  bool hostname(const char*) {
+    return true;
+  }
+  IPAddress localIP() {
+    return IPAddress();
+  }
+  bool softAP(const char*, const char* = NULL, int = 1) {
+    return true;
+  }
+  bool softAPdisconnect(bool = false) {
+    return true;
+  }
+  IPAddress softAPIP() {
+    return IPAddress(192, 168, 4, 1);
+  }
+  String softAPSSID() {
+    return String();
+  }
+  String softAPPSK() {
+    return String();
+  }
+  uint8_t softAPgetStationNum() {
+    return 0;
+  }
+};
+
+extern ESP8266WiFiClass WiFi;
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdio.h>
+#include <Arduino.h>
+
+namespace fs {
+
+class File {
+public:
+  File(FILE *file = NULL) : _file(file) {}
+
+  explicit operator bool() const {
+    return _file != NULL;
+  }
+  size_t read(uint8_t *buffer, size_t size) {
+    return _file ? fread(buffer, 1, size, _file) : 0;
+  }
+  size_t write(const uint8_t *buffer, size_t size) {
+    return _file ? fwrite(buffer, 1, size, _file) : 0;
+  }
+  void close() {
+    if (_file) {
+      fclose(_file);
+      _file = NULL;
+    }
+  }
+
+protected:
+  FILE *_file;
+};
+
+class FS { // Paths are host file names
+public:
+  File open(const char *path, const char *mode) {
+    return File(fopen(path, mode));
+  }
+  bool exists(const char *path) {
+    FILE *file = fopen(path, "r");
+
+    if (file)
+      fclose(file);
+    return file != NULL;
+  }
+  bool remove(const char *path) {
+    return ::remove(path) == 0;
+  }
+};
+
+}
+
+using fs::File;
+using fs::FS;
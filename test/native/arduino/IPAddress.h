@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+
+class IPAddress : public Printable {
+public:
+  IPAddress(uint32_t address = 0) : _address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+
+  operator uint32_t() const {
+    return _address;
+  }
+  uint8_t operator[](int index) const {
+    return _address >> (index * 8);
+  }
+  String toString() const {
+    char str[16];
+
+    snprintf(str, sizeof(str), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(str);
+  }
+  size_t printTo(Print &p) const override {
+    return p.print(toString());
+  }
+
+protected:
+  uint32_t _address;
+};
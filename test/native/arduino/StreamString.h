@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Stream.h"
+
+class StreamString : public String, public Stream {
+public:
+  size_t write(uint8_t c) override {
+    _str += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    _str.append((const char*)buffer, size);
+    return size;
+  }
+  using Print::write;
+
+  int available() override {
+    return _str.length();
+  }
+  int read() override {
+    if (_str.empty())
+      return -1;
+
+    int result = (uint8_t)_str[0];
+
+    _str.erase(0, 1);
+    return result;
+  }
+  int peek() override {
+    return _str.empty() ? -1 : (uint8_t)_str[0];
+  }
+};
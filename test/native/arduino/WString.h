@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include "pgmspace.h"
+
+class __FlashStringHelper;
+
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define F(s) FPSTR(PSTR(s))
+
+class String {
+public:
+  String(const char *str = "") : _str(str ? str : "") {}
+  String(const __FlashStringHelper *str) : String((const char*)str) {}
+  String(const std::string &str) : _str(str) {}
+  explicit String(char c) : _str(1, c) {}
+  explicit String(int value, uint8_t base = 10) : String((long)value, base) {}
+  explicit String(unsigned int value, uint8_t base = 10) : String((unsigned long)value, base) {}
+  explicit String(long value, uint8_t base = 10);
+  explicit String(unsigned long value, uint8_t base = 10);
+  explicit String(double value, uint8_t digits = 2);
+
+  String &operator=(char c) {
+    _str.assign(1, c);
+    return *this;
+  }
+
+  const char *c_str() const {
+    return _str.c_str();
+  }
+  unsigned int length() const {
+    return _str.length();
+  }
+  bool isEmpty() const {
+    return _str.empty();
+  }
+  bool reserve(unsigned int size) {
+    _str.reserve(size);
+    return true;
+  }
+
+  bool concat(const String &str) {
+    _str += str._str;
+    return true;
+  }
+  bool concat(const char *str) {
+    if (str)
+      _str += str;
+    return str != NULL;
+  }
+  bool concat(const char *str, unsigned int length) {
+    _str.append(str, length);
+    return true;
+  }
+  bool concat(const __FlashStringHelper *str) {
+    return concat((const char*)str);
+  }
+  bool concat(char c) {
+    _str += c;
+    return true;
+  }
+  bool concat(int value) {
+    return concat(String(value));
+  }
+  bool concat(unsigned int value) {
+    return concat(String(value));
+  }
+  bool concat(long value) {
+    return concat(String(value));
+  }
+  bool concat(unsigned long value) {
+    return concat(String(value));
+  }
+
+  template<typename T> String &operator+=(const T &value) {
+    concat(value);
+    return *this;
+  }
+  friend String operator+(const String &lhs, const String &rhs) {
+    return String(lhs._str + rhs._str);
+  }
+  friend String operator+(const String &lhs, const char *rhs) {
+    return String(lhs._str + rhs);
+  }
+
+  bool equals(const String &str) const {
+    return _str == str._str;
+  }
+  bool equals(const char *str) const {
+    return _str == str;
+  }
+  bool operator==(const String &str) const {
+    return equals(str);
+  }
+  bool operator==(const char *str) const {
+    return equals(str);
+  }
+  bool operator!=(const String &str) const {
+    return ! equals(str);
+  }
+  bool operator!=(const char *str) const {
+    return ! equals(str);
+  }
+
+  char charAt(unsigned int index) const {
+    return index < _str.length() ? _str[index] : 0;
+  }
+  char operator[](unsigned int index) const {
+    return charAt(index);
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t pos = _str.find(c, from);
+
+    return pos == std::string::npos ? -1 : pos;
+  }
+  int indexOf(const char *str, unsigned int from = 0) const {
+    size_t pos = _str.find(str, from);
+
+    return pos == std::string::npos ? -1 : pos;
+  }
+  String substring(unsigned int from, unsigned int to = (unsigned int)-1) const {
+    return from < _str.length() ? String(_str.substr(from, to - from)) : String();
+  }
+  long toInt() const {
+    return atol(_str.c_str());
+  }
+  float toFloat() const {
+    return atof(_str.c_str());
+  }
+
+protected:
+  std::string _str;
+};
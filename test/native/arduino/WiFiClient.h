@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <Arduino.h>
+#include "IPAddress.h"
+
+/*
+ * Host stub of TCP client, everything written is collected in output()
+ */
+class WiFiClient : public Stream {
+public:
+  size_t write(uint8_t c) override {
+    _output += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    _output.append((const char*)buffer, size);
+    return size;
+  }
+  using Print::write;
+  size_t write_P(PGM_P buffer, size_t size) {
+    return write((const uint8_t*)buffer, size);
+  }
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+  uint8_t connected() {
+    return _connected;
+  }
+  operator bool() {
+    return _connected;
+  }
+  void stop() {
+    _connected = false;
+  }
+  void setNoDelay(bool) {}
+
+  const std::string &output() const {
+    return _output;
+  }
+  void reserve(size_t size) { // Host emulation only, keeps growth of output() out of heap measurements
+    _output.reserve(size);
+  }
+
+protected:
+  std::string _output;
+  bool _connected = false;
+};
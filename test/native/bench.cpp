@@ -0,0 +1,577 @@
+/*
+ * Host benchmark of Parameters hot paths on the firmware's own table shape.
+ * Timings are relative (host CPU, not ESP8266), use them to compare revisions on the same machine.
+ * Flash traffic of update() per storage backend, heap allocations per op and peak heap are exact,
+ * they are counted by emulated flash and by replaced global operator new.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <ESP8266WebServer.h>
+#include "Parameters.h"
+#include "ParamJournal.h"
+#include "ParamSlots.h"
+#include "StrUtils.h"
+#include "WebAssets.h"
+
+constexpr char WIFI_SSID_NAME[] PROGMEM = "wifi_ssid";
+constexpr char WIFI_PSWD_NAME[] PROGMEM = "wifi_pswd";
+constexpr char MQTT_SERVER_NAME[] PROGMEM = "mqtt_server";
+constexpr char MQTT_PORT_NAME[] PROGMEM = "mqtt_port";
+constexpr char MQTT_CLIENT_NAME[] PROGMEM = "mqtt_client";
+constexpr char MQTT_CLIENT_DEF[] PROGMEM = "ESP01_Relay";
+constexpr char MQTT_USER_NAME[] PROGMEM = "mqtt_user";
+constexpr char MQTT_PSWD_NAME[] PROGMEM = "mqtt_pswd";
+constexpr char MQTT_TOPIC_NAME[] PROGMEM = "mqtt_topic";
+constexpr char MQTT_TOPIC_DEF[] PROGMEM = "/Relay";
+constexpr char MQTT_RETAINED_NAME[] PROGMEM = "mqtt_retain";
+constexpr char BOOT_STATE_NAME[] PROGMEM = "boot_state";
+constexpr char PERSISTENT_NAME[] PROGMEM = "persist";
+constexpr char NTP_SERVER_NAME[] PROGMEM = "ntp_server";
+constexpr char NTP_SERVER_DEF[] PROGMEM = "pool.ntp.org";
+constexpr char TZ_NAME[] PROGMEM = "tz";
+constexpr char STATIC_IP_NAME[] PROGMEM = "static_ip";
+constexpr char CALIBRATION_NAME[] PROGMEM = "calibration";
+constexpr char TIMEOUT_NAME[] PROGMEM = "timeout";
+constexpr char KEY_NAME[] PROGMEM = "key";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(WIFI_SSID_NAME, NULL, 33, NULL),
+  PARAM_PASSWORD(WIFI_PSWD_NAME, NULL, 33, NULL),
+  PARAM_STR(MQTT_SERVER_NAME, NULL, 33, NULL),
+  PARAM_U16(MQTT_PORT_NAME, NULL, 1883),
+  PARAM_STR(MQTT_CLIENT_NAME, NULL, 33, MQTT_CLIENT_DEF),
+  PARAM_STR(MQTT_USER_NAME, NULL, 33, NULL),
+  PARAM_PASSWORD(MQTT_PSWD_NAME, NULL, 33, NULL),
+  PARAM_STR(MQTT_TOPIC_NAME, NULL, 33, MQTT_TOPIC_DEF),
+  PARAM_BOOL(MQTT_RETAINED_NAME, NULL, false),
+  PARAM_BOOL(BOOT_STATE_NAME, NULL, false),
+  PARAM_BOOL(PERSISTENT_NAME, NULL, false),
+  PARAM_STR(NTP_SERVER_NAME, NULL, 33, NTP_SERVER_DEF),
+  PARAM_I8(TZ_NAME, NULL, 3),
+  PARAM_IP(STATIC_IP_NAME, NULL, 192, 168, 1, 100),
+  PARAM_FLOAT(CALIBRATION_NAME, NULL, 1.0),
+  PARAM_U32(TIMEOUT_NAME, NULL, 60000),
+  PARAM_BINARY(KEY_NAME, NULL, 16, NULL)
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+PARAMS_SCHEMA(SCHEMA, PARAMS);
+
+constexpr paramkey_t<uint16_t, 3> MQTT_PORT;
+constexpr paramkey_t<bool, 9> BOOT_STATE;
+
+static_assert(paramKeyValid(PARAMS, MQTT_PORT, MQTT_PORT_NAME), "Wrong MQTT_PORT key!");
+static_assert(paramKeyValid(PARAMS, BOOT_STATE, BOOT_STATE_NAME), "Wrong BOOT_STATE key!");
+
+static const char MISSING_NAME[] = "mqtt_portx";
+
+class NullStream : public Stream {
+public:
+  size_t write(uint8_t) override {
+    return 1;
+  }
+  size_t write(const uint8_t*, size_t size) override {
+    return size;
+  }
+  using Print::write;
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+};
+
+static volatile uint32_t sink; // Keeps results alive under optimization
+static uint64_t allocations; // Calls of operator new, the library and the emulated core do not use malloc() directly
+static size_t heapUsed, heapPeak; // Bytes requested from operator new and not deleted yet, high-water mark of it
+
+static const size_t HEAP_HEADER = alignof(max_align_t); // Size of block in front of the pointer returned
+
+void *operator new(size_t size) {
+  uint8_t *ptr = (uint8_t*)malloc(HEAP_HEADER + size);
+
+  if (! ptr)
+    throw std::bad_alloc();
+  *(size_t*)ptr = size;
+  ++allocations;
+  heapUsed += size;
+  if (heapUsed > heapPeak)
+    heapPeak = heapUsed;
+  return ptr + HEAP_HEADER;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  if (ptr) {
+    uint8_t *block = (uint8_t*)ptr - HEAP_HEADER;
+
+    heapUsed -= *(size_t*)block;
+    free(block);
+  }
+}
+
+void operator delete[](void *ptr) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  operator delete(ptr);
+}
+
+template<typename F> static double bench(const char *name, uint32_t count, F func) {
+  using namespace std::chrono;
+
+  func(); // Warm up
+  uint64_t allocated = allocations;
+  steady_clock::time_point start = steady_clock::now();
+  for (uint32_t i = 0; i < count; ++i)
+    func();
+  double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count() / (double)count;
+  printf("%-32s %10.1f ns/op %8.2f allocs/op\n", name, ns, (allocations - allocated) / (double)count);
+  return ns;
+}
+
+// Most heap bytes held at once by one call above what was allocated before it
+template<typename F> static size_t peakHeap(const char *name, F func) {
+  size_t used = heapUsed;
+
+  heapPeak = used;
+  func();
+  printf("%-32s %10u bytes peak heap\n", name, (unsigned)(heapPeak - used));
+  return heapPeak - used;
+}
+
+// Bit-by-bit CRC-CCITT that crc16() used before the table, reference of its results and speed
+static uint16_t crc16Bitwise(const uint8_t *data, uint16_t size, uint16_t crc = 0xFFFF) {
+  while (size--) {
+    crc ^= *data++ << 8;
+    for (uint8_t i = 0; i < 8; ++i)
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+  }
+  return crc;
+}
+
+// fromString() parsed numbers and IP with this helper before parse*(): input and format copied to stack, then vsscanf()
+static int sscanfP(const char *str, const char *fmt, ...) {
+  va_list vargs;
+  int result;
+  char _str[strlen_P(str) + 1];
+  char _fmt[strlen_P(fmt) + 1];
+
+  strcpy_P(_str, str);
+  strcpy_P(_fmt, fmt);
+  va_start(vargs, fmt);
+  result = vsscanf(_str, _fmt, vargs);
+  va_end(vargs);
+  return result;
+}
+
+template<typename F1, typename F2> static void benchParse(const char *name, uint32_t count, F1 old, F2 current) {
+  char title[48];
+
+  snprintf(title, sizeof(title), "sscanf_P() %s", name);
+  double ns = bench(title, count, old);
+  snprintf(title, sizeof(title), "parse*() %s", name);
+  double parseNs = bench(title, count, current);
+  snprintf(title, sizeof(title), "%s parses", name);
+  printf("%-32s %10.2f M/s sscanf_P(), %.2f M/s parse*()\n", title, 1000.0 / ns, 1000.0 / parseNs);
+}
+
+template<typename F1, typename F2> static void benchFormat(const char *name, uint32_t count, F1 old, F2 current) {
+  char title[48];
+
+  snprintf(title, sizeof(title), "snprintf() %s", name);
+  double ns = bench(title, count, old);
+  snprintf(title, sizeof(title), "format*() %s", name);
+  double formatNs = bench(title, count, current);
+  snprintf(title, sizeof(title), "%s formats", name);
+  printf("%-32s %10.2f M/s snprintf(), %.2f M/s format*()\n", title, 1000.0 / ns, 1000.0 / formatNs);
+}
+
+static void benchUpdate(const char *name, ParamStorage &storage, uint32_t count) {
+  using namespace std::chrono;
+
+  ESP.flashClear();
+
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  if (! params.begin()) {
+    printf("%-32s begin FAIL!\n", name);
+    return;
+  }
+  params.update();
+
+  uint32_t written = ESP.flashWritten();
+  uint64_t allocated = allocations;
+  steady_clock::time_point start = steady_clock::now();
+
+  for (uint32_t i = 0; i < count; ++i) {
+    params.set(BOOT_STATE, (bool)(i & 1));
+    params.update();
+  }
+  double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count() / (double)count;
+  uint32_t erases = 0;
+
+  for (uint32_t sector = 0; sector < EspClass::FLASH_SIZE / SPI_FLASH_SEC_SIZE; ++sector)
+    erases += ESP.flashErases(sector);
+  printf("%-32s %10.1f ns/op %8.2f allocs/op %8.1f bytes/op %6u erases\n", name, ns, (allocations - allocated) / (double)count,
+    (ESP.flashWritten() - written) / (double)count, erases);
+}
+
+/*
+ * Table of count parameters of mixed types with generated names ("param000"...),
+ * layout is built by begin() as for tables without PARAMS_LAYOUT
+ */
+struct generated_t {
+  std::vector<std::string> names;
+  std::vector<paraminfo_t> params;
+};
+
+static void generateParams(generated_t &gen, uint16_t count) {
+  gen.names.clear();
+  gen.params.clear();
+  gen.names.reserve(count); // Names must not move
+  gen.params.reserve(count);
+  for (uint16_t i = 0; i < count; ++i) {
+    char name[16];
+
+    snprintf(name, sizeof(name), "param%03u", i);
+    gen.names.push_back(name);
+
+    const char *n = gen.names.back().c_str();
+
+    switch (i % 6) {
+      case 0:
+        gen.params.push_back(paraminfo_t PARAM_U16(n, NULL, i));
+        break;
+      case 1:
+        gen.params.push_back(paraminfo_t PARAM_STR(n, NULL, 33, NULL));
+        break;
+      case 2:
+        gen.params.push_back(paraminfo_t PARAM_BOOL(n, NULL, (bool)(i & 1)));
+        break;
+      case 3:
+        gen.params.push_back(paraminfo_t PARAM_U32(n, NULL, i));
+        break;
+      case 4:
+        gen.params.push_back(paraminfo_t PARAM_FLOAT(n, NULL, (float)i));
+        break;
+      default:
+        gen.params.push_back(paraminfo_t PARAM_I8(n, NULL, 0));
+    }
+  }
+}
+
+// Offset of field as getPtr() found it before precomputed offsets: walk over all preceding descriptors
+static uint16_t walkOffset(const paraminfo_t *params, uint16_t index) {
+  uint16_t offset = 0;
+
+  for (uint16_t i = 0; i < index; ++i)
+    offset += pgm_read_word(&params[i].size);
+  return offset;
+}
+
+static void benchScaling(uint16_t count, uint32_t iterations) {
+  generated_t gen;
+  RAMStorage ram;
+  char name[32];
+
+  generateParams(gen, count);
+
+  Parameters params(gen.params.data(), count, &ram);
+
+  if (! params.begin()) {
+    printf("Parameters of %u begin FAIL!\n", count);
+    return;
+  }
+
+  uint16_t index = 0;
+
+  snprintf(name, sizeof(name), "find() hit, %u params", count);
+  bench(name, iterations, [&]() {
+    sink = params.find(gen.names[index].c_str());
+    if (++index >= count)
+      index = 0;
+  });
+  snprintf(name, sizeof(name), "value(index), %u params", count);
+  bench(name, iterations, [&]() {
+    sink = (uintptr_t)params.value(index);
+    if (++index >= count)
+      index = 0;
+  });
+  snprintf(name, sizeof(name), "offset walk, %u params", count);
+  bench(name, iterations, [&]() {
+    sink = walkOffset(gen.params.data(), index);
+    if (++index >= count)
+      index = 0;
+  });
+  snprintf(name, sizeof(name), "value(name), %u params", count);
+  bench(name, iterations, [&]() {
+    sink = (uintptr_t)params.value(gen.names[index].c_str());
+    if (++index >= count)
+      index = 0;
+  });
+}
+
+int main() {
+  const uint32_t COUNT = 1000000;
+
+  EEPROMStorage eeprom;
+  Parameters params(PARAMS, LAYOUT, &eeprom);
+
+  if (! params.begin()) {
+    printf("Parameters begin FAIL!\n");
+    return 1;
+  }
+
+  uint16_t index = 0;
+
+  bench("find() hit", COUNT, [&]() {
+    sink = params.find((const char*)pgm_read_ptr(&PARAMS[index].name));
+    if (++index >= ARRAY_SIZE(PARAMS))
+      index = 0;
+  });
+  bench("find() miss", COUNT, [&]() {
+    sink = params.find(MISSING_NAME);
+  });
+  bench("value(index)", COUNT, [&]() {
+    sink = *(const uint16_t*)params.value(3);
+  });
+  bench("value(paramkey_t)", COUNT, [&]() {
+    sink = params.value(MQTT_PORT);
+  });
+  bench("value(name)", COUNT, [&]() {
+    sink = *(const uint16_t*)params.value(MQTT_PORT_NAME);
+  });
+  bench("set(paramkey_t)", COUNT, [&]() {
+    params.set(MQTT_PORT, (uint16_t)(index++ & 0x3FFF));
+  });
+  benchScaling(10, COUNT);
+  benchScaling(50, COUNT);
+  benchScaling(200, COUNT);
+
+  NullStream null;
+
+  bench("toStream() all", COUNT / 10, [&]() {
+    for (uint16_t i = 0; i < params.count(); ++i)
+      sink = params.toStream(i, null);
+  });
+
+  const String port("8883"), topic("/home/relay"), ip("10.0.0.2"), calibration("0.975");
+
+  bench("fromString() U16", COUNT, [&]() {
+    sink = params.fromString(3, port);
+  });
+  bench("fromString() STR", COUNT, [&]() {
+    sink = params.fromString(7, topic);
+  });
+  bench("fromString() IP", COUNT, [&]() {
+    sink = params.fromString(13, ip);
+  });
+  bench("fromString() FLOAT", COUNT, [&]() {
+    sink = params.fromString(14, calibration);
+  });
+
+  {
+    const char u16[] = "8883", i32[] = "-1234567", flt[] = "0.975", ip[] = "192.168.100.200";
+    uint16_t u16Value;
+    int32_t i32Value;
+    float floatValue;
+    uint8_t ipValue[4];
+
+    benchParse("U16", COUNT, [&]() {
+      sink = sscanfP(u16, PSTR("%hu"), &u16Value);
+    }, [&]() {
+      uint32_t value;
+
+      sink = parseUInt(u16, value, UINT16_MAX);
+    });
+    benchParse("I32", COUNT, [&]() {
+      sink = sscanfP(i32, PSTR("%d"), &i32Value);
+    }, [&]() {
+      sink = parseInt(i32, i32Value);
+    });
+    benchParse("FLOAT", COUNT, [&]() {
+      sink = sscanfP(flt, PSTR("%f"), &floatValue);
+    }, [&]() {
+      sink = parseFloat(flt, floatValue);
+    });
+    benchParse("IP", COUNT, [&]() {
+      sink = sscanfP(ip, PSTR("%hhu.%hhu.%hhu.%hhu"), &ipValue[0], &ipValue[1], &ipValue[2], &ipValue[3]);
+    }, [&]() {
+      sink = parseIP(ip, ipValue);
+    });
+
+    char buf[FORMAT_SIZE];
+
+    benchFormat("U16", COUNT, [&]() {
+      sink = snprintf(buf, sizeof(buf), "%u", (uint16_t)8883);
+    }, [&]() {
+      sink = formatUInt(buf, (uint16_t)8883);
+    });
+    benchFormat("I32", COUNT, [&]() {
+      sink = snprintf(buf, sizeof(buf), "%d", (int32_t)-1234567);
+    }, [&]() {
+      sink = formatInt(buf, (int32_t)-1234567);
+    });
+    benchFormat("FLOAT", COUNT, [&]() { // %g is not round-trip, %.9g is
+      sink = snprintf(buf, sizeof(buf), "%.9g", 0.975f);
+    }, [&]() {
+      sink = formatFloat(buf, 0.975f);
+    });
+    benchFormat("IP", COUNT, [&]() {
+      sink = snprintf(buf, sizeof(buf), "%u.%u.%u.%u", ipValue[0], ipValue[1], ipValue[2], ipValue[3]);
+    }, [&]() {
+      sink = formatIP(buf, ipValue);
+    });
+  }
+
+  uint8_t image[512];
+
+  srand(1);
+  for (uint16_t n = 0; n < 10000; ++n) { // Random buffers of random length
+    uint16_t len = rand() % (sizeof(image) + 1);
+
+    for (uint16_t i = 0; i < len; ++i)
+      image[i] = rand();
+    if (Parameters::crc16(image, len) != crc16Bitwise(image, len)) {
+      printf("crc16() differs from bitwise CRC on %u bytes, FAIL!\n", len);
+      return 1;
+    }
+  }
+
+  double bitwise = bench("crc16() bitwise 512 bytes", COUNT / 100, [&]() {
+    sink = crc16Bitwise(image, sizeof(image));
+  });
+  double table = bench("crc16() 512 bytes", COUNT / 10, [&]() {
+    sink = Parameters::crc16(image, sizeof(image));
+  });
+
+  printf("%-32s %10.1f bytes/us bitwise, %.1f bytes/us table\n", "crc16() throughput", sizeof(image) * 1000.0 / bitwise,
+    sizeof(image) * 1000.0 / table);
+
+  bench("update() unchanged", COUNT, [&]() {
+    sink = params.update();
+  });
+
+  RAMStorage ram;
+  Parameters schema(SCHEMA, LAYOUT, &ram);
+
+  schema.begin();
+  bench("begin() table", COUNT / 10, [&]() {
+    Parameters other(PARAMS, LAYOUT, &ram);
+
+    sink = other.begin();
+  });
+  bench("begin() schema", COUNT / 10, [&]() {
+    Parameters other(SCHEMA, LAYOUT, &ram);
+
+    sink = other.begin();
+  });
+  bench("handleWebPage() table", COUNT / 100, [&]() {
+    ESP8266WebServer http;
+
+    http.request(HTTP_GET, "/");
+    params.handleWebPage(http, NULL);
+    sink = http.client().output().size();
+  });
+  bench("handleWebPage() schema", COUNT / 100, [&]() {
+    ESP8266WebServer http;
+
+    http.request(HTTP_GET, "/");
+    schema.handleWebPage(http, NULL);
+    sink = http.client().output().size();
+  });
+
+  {
+    generated_t gen;
+    RAMStorage genRam;
+
+    generateParams(gen, 50);
+
+    Parameters generated(gen.params.data(), gen.params.size(), &genRam);
+    size_t pageSize = 0;
+
+    if (generated.begin()) {
+      bench("handleWebPage() 50 params", COUNT / 100, [&]() {
+        ESP8266WebServer http;
+
+        http.request(HTTP_GET, "/setup");
+        generated.handleWebPage(http, &WEB_PARAMS_JS);
+        sink = pageSize = http.client().output().size();
+      });
+      printf("%-32s %10u bytes/page\n", "handleWebPage() 50 params", (unsigned)pageSize);
+
+      ESP8266WebServer http;
+
+      http.request(HTTP_GET, "/setup");
+      http.client().reserve(65536);
+      peakHeap("handleWebPage() 50 params", [&]() {
+        generated.handleWebPage(http, &WEB_PARAMS_JS);
+      });
+    } else
+      printf("Parameters of 50 begin FAIL!\n");
+  }
+
+  {
+    const uint16_t PAGE_SIZE = 2396; // Uncompressed web/index.html, the root page was a heap String of this size
+    char *page = new char[PAGE_SIZE + 1];
+    ESP8266WebServer http;
+
+    memset(page, ' ', PAGE_SIZE);
+    page[PAGE_SIZE] = '\0';
+    http.request(HTTP_GET, "/");
+    http.client().reserve(16384);
+    peakHeap("root page String", [&]() { // As httpRootPage() assembled it before streaming from flash
+      String content;
+
+      content = page + PAGE_SIZE / 2;
+      content.concat(F(" checked"));
+      content.concat(page + PAGE_SIZE / 2);
+      http.send(200, F("text/html"), content);
+    });
+    http.request(HTTP_GET, "/");
+    http.client().reserve(16384);
+    peakHeap("root page sendWebAsset()", [&]() {
+      sendWebAsset(http, WEB_INDEX_HTML);
+    });
+    http.request(HTTP_GET, "/");
+    http.client().reserve(16384);
+    peakHeap("handleWebPage() table", [&]() {
+      params.handleWebPage(http, NULL);
+    });
+    http.request(HTTP_GET, "/");
+    http.client().reserve(16384);
+    peakHeap("handleWebPage() schema", [&]() {
+      schema.handleWebPage(http, NULL);
+    });
+    delete[] page;
+  }
+
+  ParamSlots slots(0);
+  ParamJournal journal(0, 16);
+
+  benchUpdate("update() EEPROMStorage", eeprom, 10000);
+  benchUpdate("update() ParamSlots", slots, 10000);
+  benchUpdate("update() ParamJournal x16", journal, 10000);
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include <Arduino.h>
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include "StrUtils.h"
+#include "unit.h"
+
+static uint32_t randomState = 1;
+
+static uint32_t random32() { // xorshift32, the same sequence on every run
+  randomState ^= randomState << 13;
+  randomState ^= randomState >> 17;
+  randomState ^= randomState << 5;
+  return randomState;
+}
+
+static float floatOf(uint32_t bits) {
+  float result;
+
+  memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+static uint32_t bitsOf(float value) {
+  uint32_t result;
+
+  memcpy(&result, &value, sizeof(result));
+  return result;
+}
+
+// Significant digits of formatted number
+static uint8_t digitsOf(const char *str) {
+  uint8_t result = 0;
+  bool leading = true;
+
+  for (; *str && (*str != 'e'); ++str) {
+    if ((*str < '0') || (*str > '9'))
+      continue;
+    if (leading && (*str == '0'))
+      continue;
+    leading = false;
+    ++result;
+  }
+  while (result && (str[-1] == '0')) { // Trailing zeros of integer part
+    --result;
+    --str;
+  }
+  return result ? result : 1;
+}
+
+// Least number of significant digits that reads back to the same float
+static uint8_t shortestDigits(float value) {
+  char buf[32];
+
+  for (uint8_t precision = 1; precision < 9; ++precision) {
+    snprintf(buf, sizeof(buf), "%.*e", precision - 1, value);
+    if (strtof(buf, NULL) == value)
+      return precision;
+  }
+  return 9;
+}
+
+static bool checkFloat(float value) {
+  char buf[FORMAT_SIZE];
+  uint8_t len = formatFloat(buf, value);
+
+  if ((len != strlen(buf)) || (len >= FORMAT_SIZE) || (bitsOf(strtof(buf, NULL)) != bitsOf(value))) {
+    printf("formatFloat(%.9g) = \"%s\" does not read back\n", value, buf);
+    return false;
+  }
+  if ((value != 0) && (digitsOf(buf) != shortestDigits(value))) {
+    printf("formatFloat(%.9g) = \"%s\" is not the shortest (%u digits)\n", value, buf, shortestDigits(value));
+    return false;
+  }
+  return true;
+}
+
+static bool checkUInt(uint32_t value) {
+  char buf[FORMAT_SIZE], expected[16];
+
+  snprintf(expected, sizeof(expected), "%u", value);
+  return (formatUInt(buf, value) == strlen(expected)) && (! strcmp(buf, expected));
+}
+
+static bool checkInt(int32_t value) {
+  char buf[FORMAT_SIZE], expected[16];
+
+  snprintf(expected, sizeof(expected), "%d", value);
+  return (formatInt(buf, value) == strlen(expected)) && (! strcmp(buf, expected));
+}
+
+static const char *format(float value) {
+  static char buf[FORMAT_SIZE];
+
+  formatFloat(buf, value);
+  return buf;
+}
+
+static void testIntegers() {
+  CHECK(checkUInt(0));
+  CHECK(checkUInt(9));
+  CHECK(checkUInt(10));
+  CHECK(checkUInt(99));
+  CHECK(checkUInt(100));
+  CHECK(checkUInt(1000000000));
+  CHECK(checkUInt(UINT32_MAX));
+  CHECK(checkInt(0));
+  CHECK(checkInt(-1));
+  CHECK(checkInt(INT32_MAX));
+  CHECK(checkInt(INT32_MIN));
+
+  uint32_t failed = 0;
+
+  for (uint32_t i = 0; i < 1000000; ++i) {
+    uint32_t value = random32() >> (i % 32); // All lengths
+
+    if (! (checkUInt(value) && checkInt(value)))
+      ++failed;
+  }
+  CHECK(! failed);
+}
+
+static void testFloatEdges() {
+  CHECK(! strcmp(format(0.0f), "0"));
+  CHECK(! strcmp(format(-0.0f), "-0"));
+  CHECK(! strcmp(format(NAN), "nan"));
+  CHECK(! strcmp(format(INFINITY), "inf"));
+  CHECK(! strcmp(format(-INFINITY), "-inf"));
+  CHECK(! strcmp(format(0.1f), "0.1"));
+  CHECK(! strcmp(format(1.0f), "1"));
+  CHECK(! strcmp(format(100.0f), "100"));
+  CHECK(! strcmp(format(0.975f), "0.975"));
+  CHECK(! strcmp(format(1e9f), "1e9")); // First exponent in scientific notation
+  CHECK(! strcmp(format(1e8f), "100000000"));
+  CHECK(! strcmp(format(1e-5f), "0.00001")); // Last exponent in plain notation
+  CHECK(! strcmp(format(1e-6f), "1e-6"));
+  CHECK(! strcmp(format(-1.5e-7f), "-1.5e-7"));
+  CHECK(! strcmp(format(FLT_MAX), "3.4028235e38"));
+  CHECK(! strcmp(format(FLT_MIN), "1.1754944e-38"));
+  CHECK(! strcmp(format(floatOf(1)), "1e-45")); // Least denormal
+
+  const float edges[] = { -0.0f, FLT_MAX, -FLT_MAX, FLT_MIN, floatOf(1), floatOf(0x007FFFFF), 1e9f, 1e-5f, 16777216.0f, 16777217.0f,
+    4294967296.0f };
+
+  for (uint8_t i = 0; i < sizeof(edges) / sizeof(edges[0]); ++i) {
+    CHECK(checkFloat(edges[i]));
+    CHECK(checkFloat(nextafterf(edges[i], 0)));
+    CHECK(checkFloat(nextafterf(edges[i], INFINITY)));
+  }
+}
+
+static void testFloatRoundTrip() {
+  uint32_t failed = 0;
+
+  for (uint32_t i = 0; i < 2000000; ++i) {
+    float value = floatOf(random32());
+
+    if (isnan(value) || isinf(value))
+      continue;
+    if (! checkFloat(value)) {
+      if (++failed >= 10)
+        break;
+    }
+  }
+  CHECK(! failed);
+}
+
+int main() {
+  RUN_TEST(testIntegers);
+  RUN_TEST(testFloatEdges);
+  RUN_TEST(testFloatRoundTrip);
+  return unitResult();
+}
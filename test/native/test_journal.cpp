@@ -0,0 +1,191 @@
+#include <Arduino.h>
+#include "Parameters.h"
+#include "ParamJournal.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char STATE_NAME[] PROGMEM = "state";
+constexpr char COUNTER_NAME[] PROGMEM = "counter";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_BOOL(STATE_NAME, NULL, false),
+  PARAM_U32(COUNTER_NAME, NULL, 0)
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<uint16_t, 1> PORT;
+constexpr paramkey_t<bool, 2> STATE;
+constexpr paramkey_t<uint32_t, 3> COUNTER;
+
+const uint32_t SECTOR = 16;
+const uint8_t SECTORS = 16;
+
+static void testOneSectorRejected() {
+  ESP.flashClear();
+
+  ParamJournal journal(SECTOR, 1);
+  Parameters params(PARAMS, LAYOUT, &journal);
+
+  CHECK(! params.begin());
+  CHECK(! ESP.flashErases(SECTOR));
+}
+
+static void testTwoSectorsKeepLiveImage() {
+  ESP.flashClear();
+
+  ParamJournal journal(SECTOR, 2);
+  Parameters params(PARAMS, LAYOUT, &journal);
+
+  CHECK(params.begin());
+  for (uint32_t i = 1; i <= 2000; ++i) { // Several compactions back and forth
+    params.set(COUNTER, i);
+    CHECK(params.update());
+  }
+  CHECK(ESP.flashErases(SECTOR) > 1);
+  CHECK(ESP.flashErases(SECTOR + 1) > 1);
+
+  ParamJournal reopened(SECTOR, 2);
+  Parameters restored(PARAMS, LAYOUT, &reopened);
+
+  CHECK(restored.begin());
+  CHECK(restored.value(COUNTER) == 2000);
+}
+
+/*
+ * Simulates years of relay toggling (one commit per toggle) and checks that erases are spread
+ * evenly over the ring and are far below the one erase per commit of EEPROMStorage
+ */
+static void testWearLeveling() {
+  const uint32_t COMMITS = 100000;
+
+  ESP.flashClear();
+
+  ParamJournal journal(SECTOR, SECTORS);
+  Parameters params(PARAMS, LAYOUT, &journal);
+
+  CHECK(params.begin());
+  CHECK(params.fromString(SSID_NAME, "HomeNetwork"));
+  CHECK(params.update());
+  for (uint32_t i = 0; i < COMMITS; ++i) {
+    params.set(STATE, (bool)(i & 1));
+    if (! (i % 1000)) // Rare change of another parameter
+      params.set(PORT, (uint16_t)(1883 + i / 1000));
+    CHECK(params.update());
+  }
+
+  uint32_t total = 0, minErases = UINT32_MAX, maxErases = 0;
+
+  for (uint8_t i = 0; i < SECTORS; ++i) {
+    uint32_t erases = ESP.flashErases(SECTOR + i);
+
+    total += erases;
+    if (erases < minErases)
+      minErases = erases;
+    if (erases > maxErases)
+      maxErases = erases;
+  }
+  printf("%u commits: %u erases in %u sectors (%u..%u per sector), %.1f bytes written per commit\n",
+    COMMITS, total, SECTORS, minErases, maxErases, ESP.flashWritten() / (double)COMMITS);
+  CHECK(ESP.flashErases(SECTOR - 1) == 0); // Nothing outside of the ring
+  CHECK(ESP.flashErases(SECTOR + SECTORS) == 0);
+  CHECK(maxErases - minErases <= 1);
+  CHECK(total * 100 < COMMITS); // Less than 1% of EEPROMStorage erases
+
+  ParamJournal reopened(SECTOR, SECTORS);
+  Parameters restored(PARAMS, LAYOUT, &reopened);
+
+  CHECK(restored.begin());
+  CHECK(restored.value(STATE) == (bool)((COMMITS - 1) & 1));
+  CHECK(restored.value(PORT) == 1883 + (COMMITS - 1) / 1000);
+  CHECK(! strcmp((const char*)restored.value(SSID_NAME), "HomeNetwork"));
+}
+
+static uint32_t ringErases() {
+  return ESP.flashErases(SECTOR) + ESP.flashErases(SECTOR + 1);
+}
+
+/*
+ * Cuts power after every possible number of bytes of one commit (record append and compaction):
+ * the next begin() must see either the old or the new value, and the journal must keep working
+ */
+static void testPowerLoss() {
+  uint32_t toggles = 0; // Commits that fit into the sector after the first one
+
+  ESP.flashClear();
+  {
+    ParamJournal journal(SECTOR, 2);
+    Parameters params(PARAMS, LAYOUT, &journal);
+
+    CHECK(params.begin());
+    params.set(COUNTER, (uint32_t)1);
+    CHECK(params.update());
+
+    uint32_t erases = ringErases();
+
+    while (ringErases() == erases) {
+      params.set(STATE, (bool)(toggles & 1));
+      CHECK(params.update());
+      ++toggles;
+    }
+  }
+  CHECK(toggles > 1);
+  for (uint8_t compaction = 0; compaction < 2; ++compaction) {
+    for (int32_t cut = 0; ; cut += 4) {
+      ESP.flashClear();
+
+      uint32_t erases, written;
+
+      {
+        ParamJournal journal(SECTOR, 2);
+        Parameters params(PARAMS, LAYOUT, &journal);
+
+        CHECK(params.begin());
+        params.set(COUNTER, (uint32_t)1);
+        CHECK(params.update());
+        erases = ringErases();
+        for (uint32_t i = 0; compaction && (i < toggles - 1); ++i) { // Sector is full, so the next commit compacts
+          params.set(STATE, (bool)(i & 1));
+          params.update();
+        }
+        written = ESP.flashWritten();
+        ESP.flashFailAfter(cut);
+        params.set(COUNTER, (uint32_t)2);
+        params.update();
+        ESP.flashFailAfter(-1);
+      }
+
+      bool completed = ESP.flashWritten() - written < (uint32_t)cut;
+      ParamJournal journal(SECTOR, 2);
+      Parameters params(PARAMS, LAYOUT, &journal);
+
+      CHECK(params.begin());
+      CHECK((params.value(COUNTER) == 1) || (params.value(COUNTER) == 2));
+      if (completed) {
+        CHECK(params.value(COUNTER) == 2);
+        CHECK(ringErases() == erases + compaction);
+      }
+      params.set(COUNTER, (uint32_t)3);
+      CHECK(params.update());
+
+      ParamJournal reopened(SECTOR, 2);
+      Parameters restored(PARAMS, LAYOUT, &reopened);
+
+      CHECK(restored.begin());
+      CHECK(restored.value(COUNTER) == 3);
+      if (completed)
+        break;
+    }
+  }
+}
+
+int main() {
+  RUN_TEST(testOneSectorRejected);
+  RUN_TEST(testTwoSectorsKeepLiveImage);
+  RUN_TEST(testWearLeveling);
+  RUN_TEST(testPowerLoss);
+  return unitResult();
+}
@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <StreamString.h>
+#include "Parameters.h"
+#include "JsonTokenizer.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char CERT_NAME[] PROGMEM = "cert";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char RETAIN_NAME[] PROGMEM = "retain";
+constexpr char CALIBRATION_NAME[] PROGMEM = "calibration";
+constexpr char KEY_NAME[] PROGMEM = "key";
+constexpr char IP_NAME[] PROGMEM = "ip";
+constexpr char LETTER_NAME[] PROGMEM = "letter";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_STR(CERT_NAME, NULL, 1025, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_FLOAT(CALIBRATION_NAME, NULL, 1.0),
+  PARAM_BINARY(KEY_NAME, NULL, 300, NULL),
+  PARAM_IP(IP_NAME, NULL, 192, 168, 1, 100),
+  PARAM_CHAR(LETTER_NAME, NULL, 'a')
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<const char*, 0> SSID;
+constexpr paramkey_t<const char*, 1> CERT;
+constexpr paramkey_t<uint16_t, 2> PORT;
+constexpr paramkey_t<bool, 3> RETAIN;
+constexpr paramkey_t<float, 4> CALIBRATION;
+
+static bool fromJson(Parameters &params, const char *json) {
+  return params.fromJson(json, strlen(json));
+}
+
+static void testTokenizer() {
+  const char JSON[] = " {\"a\\\"b\" : -1.5e3,\n\"x\":[true, false, null, 0]} ";
+  const JsonTokenizer::token_t TOKENS[] = { JsonTokenizer::JSON_BEGIN_OBJECT, JsonTokenizer::JSON_STRING, JsonTokenizer::JSON_COLON,
+    JsonTokenizer::JSON_NUMBER, JsonTokenizer::JSON_COMMA, JsonTokenizer::JSON_STRING, JsonTokenizer::JSON_COLON, JsonTokenizer::JSON_BEGIN_ARRAY,
+    JsonTokenizer::JSON_TRUE, JsonTokenizer::JSON_COMMA, JsonTokenizer::JSON_FALSE, JsonTokenizer::JSON_COMMA, JsonTokenizer::JSON_NULL,
+    JsonTokenizer::JSON_COMMA, JsonTokenizer::JSON_NUMBER, JsonTokenizer::JSON_END_ARRAY, JsonTokenizer::JSON_END_OBJECT, JsonTokenizer::JSON_END };
+  JsonTokenizer tokens(JSON, strlen(JSON));
+  char buf[8];
+
+  for (uint8_t i = 0; i < ARRAY_SIZE(TOKENS); ++i) {
+    CHECK(tokens.next() == TOKENS[i]);
+    if (i == 1) {
+      CHECK(tokens.tokenLength() == 4); // Raw token without quotes
+      CHECK(tokens.unescape(buf, sizeof(buf)) == 3);
+      CHECK(! strcmp(buf, "a\"b"));
+    } else if (i == 3)
+      CHECK((tokens.tokenLength() == 6) && (! strncmp(tokens.token(), "-1.5e3", 6)));
+  }
+  CHECK(tokens.next() == JsonTokenizer::JSON_END); // And stays there
+
+  const char *const ERRORS[] = { "\"open", "\"tab\t\"", "tru", "nul", "-", "1.", "1e", "+1", "'a'", "\"\\" };
+
+  for (uint8_t i = 0; i < ARRAY_SIZE(ERRORS); ++i) {
+    JsonTokenizer error(ERRORS[i], strlen(ERRORS[i]));
+
+    CHECK(error.next() == JsonTokenizer::JSON_ERROR);
+  }
+}
+
+static void testUnescape() {
+  const char JSON[] = "\"\\n\\t\\\\\\/\\u0041\\u00e9\\u20ac\" \"\\u0000\" \"\\u12\" \"12345678\"";
+  JsonTokenizer tokens(JSON, strlen(JSON));
+  char buf[16];
+
+  CHECK(tokens.next() == JsonTokenizer::JSON_STRING);
+  CHECK(tokens.unescape(buf, sizeof(buf)) == 10);
+  CHECK(! strcmp(buf, "\n\t\\/A\xC3\xA9\xE2\x82\xAC"));
+  CHECK(tokens.unescape(buf, 10) == -1); // No room for '\0'
+  CHECK(tokens.next() == JsonTokenizer::JSON_STRING);
+  CHECK(tokens.unescape(buf, sizeof(buf)) == -1); // Would truncate C string
+  CHECK(tokens.next() == JsonTokenizer::JSON_STRING);
+  CHECK(tokens.unescape(buf, sizeof(buf)) == -1);
+  CHECK(tokens.next() == JsonTokenizer::JSON_STRING);
+  CHECK(tokens.unescape(buf, 8) == -1);
+  CHECK(tokens.unescape(buf, 9) == 8);
+}
+
+static void testRoundTrip() {
+  RAMStorage storage, otherStorage;
+  Parameters params(PARAMS, LAYOUT, &storage), other(PARAMS, LAYOUT, &otherStorage);
+  std::string cert;
+
+  CHECK(params.begin());
+  CHECK(other.begin());
+  for (uint16_t i = 0; cert.length() < 1024; ++i) // Every escaped char of the longest value
+    cert += i % 64 ? (char)(' ' + i % 96) : '\n';
+  CHECK(params.fromString(SSID_NAME, "quote \" back \\ tab \t ctl \x01 \xC3\xA9"));
+  CHECK(params.fromString(CERT_NAME, cert.c_str()));
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  CHECK(params.set(CALIBRATION, 0.975f));
+  CHECK(params.fromString(IP_NAME, "10.0.0.2"));
+  CHECK(params.fromString(LETTER_NAME, "\""));
+
+  uint8_t key[300];
+
+  for (uint16_t i = 0; i < sizeof(key); ++i)
+    key[i] = i * 7;
+  CHECK(params.set(5, key));
+
+  StreamString json;
+
+  CHECK(params.toJson(json));
+  CHECK(json.length() > 1024 + 400); // Long values as is, not cut to some buffer
+  CHECK(json.indexOf("\"ssid\":\"quote \\\" back \\\\ tab \\u0009 ctl \\u0001 \xC3\xA9\"") >= 0);
+  CHECK(fromJson(other, json.c_str()));
+  for (uint16_t i = 0; i < params.count(); ++i)
+    CHECK(! memcmp(params.value(i), other.value(i), params.size(i)));
+  CHECK(! strcmp(other.value(CERT), cert.c_str()));
+
+  StreamString copy;
+
+  CHECK(other.toJson(copy));
+  CHECK(copy == json);
+}
+
+static void testNull() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+  CHECK(fromJson(params, "{\"port\":8883,\"ssid\":\"HomeNetwork\",\"calibration\":0.5}"));
+  CHECK(params.value(PORT) == 8883);
+  CHECK(fromJson(params, "{\"port\":null,\"ssid\":null}"));
+  CHECK(params.value(PORT) == 1883);
+  CHECK(! *params.value(SSID));
+  CHECK(params.value(CALIBRATION) == 0.5);
+
+  StreamString json;
+
+  CHECK(params.set(CALIBRATION, NAN));
+  CHECK(params.toJson(json));
+  CHECK(json.indexOf("\"calibration\":null") >= 0); // Not representable in JSON
+  CHECK(fromJson(params, json.c_str()));
+  CHECK(params.value(CALIBRATION) == 1.0);
+}
+
+static void testRejected() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  uint32_t commits = storage.commits();
+  const char *const WRONG[] = {
+    "{\"port\":8883,\"unknown\":1}", // Unknown key
+    "{\"port\":8883,}", // Trailing comma
+    "{\"port\":8883,\"retain\":true", // No end of object
+    "{\"port\":8883}{", // Garbage after object
+    "{\"port\":70000}", // Out of range
+    "{\"port\":\"8883\",\"retain\":[true]}", // Not flat
+    "[\"port\",8883]",
+    ""
+  };
+
+  for (uint8_t i = 0; i < ARRAY_SIZE(WRONG); ++i) {
+    CHECK(! fromJson(params, WRONG[i]));
+    CHECK(! params.inTransaction());
+    CHECK(params.value(PORT) == 1883); // Rolled back as a whole
+  }
+  CHECK(storage.commits() == commits);
+  CHECK(fromJson(params, " { } "));
+  CHECK(fromJson(params, "{\"port\":\"8883\",\"retain\":true}")); // Quoted numbers are parsed as text
+  CHECK(params.value(PORT) == 8883);
+  CHECK(params.value(RETAIN));
+}
+
+int main() {
+  RUN_TEST(testTokenizer);
+  RUN_TEST(testUnescape);
+  RUN_TEST(testRoundTrip);
+  RUN_TEST(testNull);
+  RUN_TEST(testRejected);
+  return unitResult();
+}
@@ -0,0 +1,280 @@
+#include <Arduino.h>
+#include "Parameters.h"
+#include "unit.h"
+
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char RETAIN_NAME[] PROGMEM = "retain";
+constexpr char TOPIC_NAME[] PROGMEM = "topic";
+constexpr char TIMEOUT_NAME[] PROGMEM = "timeout";
+constexpr char MODE_NAME[] PROGMEM = "mode";
+constexpr char REMOVED_NAME[] PROGMEM = "removed";
+constexpr char ADDED_NAME[] PROGMEM = "added";
+constexpr char CERT_NAME[] PROGMEM = "cert";
+constexpr char ACQ_NAME[] PROGMEM = "port_acq"; // Same CRC16 of name as "port_paa"
+constexpr char PAA_NAME[] PROGMEM = "port_paa";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_STR(TOPIC_NAME, NULL, 17, NULL),
+  PARAM_U32(TIMEOUT_NAME, NULL, 60000)
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paraminfo_t V1_PARAMS[] PROGMEM = {
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_STR(TOPIC_NAME, NULL, 33, NULL),
+  PARAM_U32(TIMEOUT_NAME, NULL, 60000),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_U8(MODE_NAME, NULL, 0),
+  PARAM_U32(REMOVED_NAME, NULL, 0)
+};
+
+PARAMS_LAYOUT(V1_LAYOUT, V1_PARAMS);
+
+// V1 with large field, its image is larger than V2 one
+constexpr paraminfo_t V1_LARGE_PARAMS[] PROGMEM = {
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_STR(TOPIC_NAME, NULL, 33, NULL),
+  PARAM_U32(TIMEOUT_NAME, NULL, 60000),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_U8(MODE_NAME, NULL, 0),
+  PARAM_U32(REMOVED_NAME, NULL, 0),
+  PARAM_STR(CERT_NAME, NULL, 1025, NULL)
+};
+
+PARAMS_LAYOUT(V1_LARGE_LAYOUT, V1_LARGE_PARAMS);
+
+// Reordered, one field added, one removed, string shrunk and type of mode changed
+constexpr paraminfo_t V2_PARAMS[] PROGMEM = {
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_U16(ADDED_NAME, NULL, 42),
+  PARAM_STR(TOPIC_NAME, NULL, 9, NULL),
+  PARAM_U16(MODE_NAME, NULL, 1),
+  PARAM_U32(TIMEOUT_NAME, NULL, 60000)
+};
+
+PARAMS_LAYOUT(V2_LAYOUT, V2_PARAMS);
+
+constexpr paramkey_t<bool, 0> V2_RETAIN;
+constexpr paramkey_t<uint16_t, 1> V2_PORT;
+constexpr paramkey_t<uint16_t, 2> V2_ADDED;
+constexpr paramkey_t<const char*, 3> V2_TOPIC;
+constexpr paramkey_t<uint16_t, 4> V2_MODE;
+constexpr paramkey_t<uint32_t, 5> V2_TIMEOUT;
+
+constexpr paraminfo_t ONE_COLLIDING_PARAMS[] PROGMEM = {
+  PARAM_U16(ACQ_NAME, NULL, 1)
+};
+
+PARAMS_LAYOUT(ONE_COLLIDING_LAYOUT, ONE_COLLIDING_PARAMS);
+
+constexpr paraminfo_t BOTH_COLLIDING_PARAMS[] PROGMEM = {
+  PARAM_U16(ACQ_NAME, NULL, 1),
+  PARAM_U16(PAA_NAME, NULL, 2)
+};
+
+PARAMS_LAYOUT(BOTH_COLLIDING_LAYOUT, BOTH_COLLIDING_PARAMS);
+
+constexpr paramkey_t<uint16_t, 0> PORT;
+constexpr paramkey_t<bool, 1> RETAIN;
+constexpr paramkey_t<const char*, 2> TOPIC;
+constexpr paramkey_t<uint32_t, 3> TIMEOUT;
+
+const uint16_t SIGN = 0xA55C;
+const uint16_t SIGN_ALIGNED = 0xA55B; // Fields in current aligned layout, no directory
+const uint16_t SIGN_LEGACY = 0xA55A; // Fields packed back-to-back in table order, PARAM_BOOL takes a byte
+
+const uint16_t PORT_VALUE = 8883;
+const char TOPIC_VALUE[] = "/home/relay";
+const uint32_t TIMEOUT_VALUE = 120000;
+
+/*
+ * Commits image of previous firmware: sign and CRC of data followed by data
+ */
+static void storeImage(RAMStorage &storage, uint16_t sign, const uint8_t *data, uint16_t size) {
+  uint16_t header[2] = { sign, Parameters::crc16(data, size) };
+
+  storage.begin(sizeof(header) + size);
+  memcpy(storage.getDataPtr(), header, sizeof(header));
+  memcpy(storage.getDataPtr() + sizeof(header), data, size);
+  storage.commit();
+  storage.end();
+}
+
+static void checkMigrated(RAMStorage &storage) {
+  uint32_t commits = storage.commits();
+
+  {
+    Parameters params(PARAMS, LAYOUT, &storage);
+
+    CHECK(params.begin());
+    CHECK(params.value(PORT) == PORT_VALUE);
+    CHECK(params.value(RETAIN));
+    CHECK(! strcmp(params.value(TOPIC), TOPIC_VALUE));
+    CHECK(params.value(TIMEOUT) == TIMEOUT_VALUE);
+    CHECK(*(const uint16_t*)storage.getDataPtr() == SIGN);
+    CHECK(storage.commits() == commits + 1); // Rewritten once in current format
+  }
+
+  Parameters params(PARAMS, LAYOUT, &storage); // Next boot finds valid image
+
+  CHECK(params.begin());
+  CHECK(params.value(PORT) == PORT_VALUE);
+  CHECK(params.value(RETAIN));
+  CHECK(! strcmp(params.value(TOPIC), TOPIC_VALUE));
+  CHECK(params.value(TIMEOUT) == TIMEOUT_VALUE);
+  CHECK(storage.commits() == commits + 1);
+}
+
+static void testLegacyPacked() {
+  RAMStorage storage;
+  uint8_t data[sizeof(uint16_t) + sizeof(bool) + 17 + sizeof(uint32_t)] = {};
+  uint8_t *ptr = data;
+
+  memcpy(ptr, &PORT_VALUE, sizeof(PORT_VALUE));
+  ptr += sizeof(PORT_VALUE);
+  *ptr++ = true;
+  strcpy((char*)ptr, TOPIC_VALUE);
+  ptr += 17;
+  memcpy(ptr, &TIMEOUT_VALUE, sizeof(TIMEOUT_VALUE));
+  storeImage(storage, SIGN_LEGACY, data, sizeof(data));
+  checkMigrated(storage);
+}
+
+static void testAligned() {
+  RAMStorage storage;
+  uint8_t data[LAYOUT.dataSize] = {};
+
+  memcpy(&data[LAYOUT.offsets[PORT.index]], &PORT_VALUE, sizeof(PORT_VALUE));
+  data[LAYOUT.bitsOffset + LAYOUT.offsets[RETAIN.index] / 8] |= 1 << (LAYOUT.offsets[RETAIN.index] % 8);
+  strcpy((char*)&data[LAYOUT.offsets[TOPIC.index]], TOPIC_VALUE);
+  memcpy(&data[LAYOUT.offsets[TIMEOUT.index]], &TIMEOUT_VALUE, sizeof(TIMEOUT_VALUE));
+  storeImage(storage, SIGN_ALIGNED, data, sizeof(data));
+  checkMigrated(storage);
+}
+
+static const char LONG_TOPIC[] = "/home/relay/long/topic";
+
+template<size_t N> static void storeV1(RAMStorage &storage, const paraminfo_t (&params)[N], const paramlayout_t<N> &layout) {
+  Parameters v1(params, layout, &storage);
+
+  CHECK(v1.begin());
+  CHECK(v1.fromString(PORT_NAME, "8883"));
+  CHECK(v1.fromString(TOPIC_NAME, LONG_TOPIC));
+  CHECK(v1.fromString(TIMEOUT_NAME, "120000"));
+  CHECK(v1.fromString(RETAIN_NAME, "true"));
+  CHECK(v1.fromString(MODE_NAME, "5"));
+  CHECK(v1.fromString(REMOVED_NAME, "77"));
+  CHECK(v1.update());
+}
+
+static void checkV2(RAMStorage &storage) {
+  uint32_t commits = storage.commits();
+
+  {
+    Parameters params(V2_PARAMS, V2_LAYOUT, &storage);
+
+    CHECK(params.begin());
+    CHECK(params.value(V2_RETAIN));
+    CHECK(params.value(V2_PORT) == 8883);
+    CHECK(params.value(V2_ADDED) == 42);
+    CHECK(! strcmp(params.value(V2_TOPIC), "/home/re")); // Truncated
+    CHECK(params.value(V2_MODE) == 1); // Type changed, default
+    CHECK(params.value(V2_TIMEOUT) == 120000);
+    CHECK(storage.commits() == commits + 1);
+  }
+
+  Parameters params(V2_PARAMS, V2_LAYOUT, &storage);
+
+  CHECK(params.begin());
+  CHECK(params.value(V2_PORT) == 8883);
+  CHECK(params.value(V2_TIMEOUT) == 120000);
+  CHECK(storage.commits() == commits + 1);
+}
+
+static void testUpgrade() {
+  RAMStorage storage;
+
+  storeV1(storage, V1_PARAMS, V1_LAYOUT);
+  checkV2(storage);
+}
+
+static void testLargerImage() {
+  RAMStorage storage;
+
+  storeV1(storage, V1_LARGE_PARAMS, V1_LARGE_LAYOUT);
+  checkV2(storage);
+}
+
+static void testCrcMismatch() {
+  RAMStorage storage;
+
+  storeV1(storage, V1_PARAMS, V1_LAYOUT);
+  {
+    Parameters v1(V1_PARAMS, V1_LAYOUT, &storage);
+
+    CHECK(v1.begin());
+    ((uint8_t*)v1.value(TOPIC_NAME))[0] ^= 0x01; // Damaged without CRC update
+    CHECK(storage.commit());
+  }
+
+  uint32_t commits = storage.commits();
+  Parameters params(V2_PARAMS, V2_LAYOUT, &storage);
+
+  CHECK(params.begin());
+  CHECK(! params.value(V2_RETAIN)); // Everything is cleared
+  CHECK(params.value(V2_PORT) == 1883);
+  CHECK(params.value(V2_ADDED) == 42);
+  CHECK(! *params.value(V2_TOPIC));
+  CHECK(params.value(V2_TIMEOUT) == 60000);
+  CHECK(storage.commits() == commits + 1);
+}
+
+static void testCollidingTags() {
+  {
+    RAMStorage storage;
+
+    {
+      Parameters one(ONE_COLLIDING_PARAMS, ONE_COLLIDING_LAYOUT, &storage);
+
+      CHECK(one.begin());
+      CHECK(one.fromString(ACQ_NAME, "7"));
+      CHECK(one.update());
+    }
+
+    Parameters both(BOTH_COLLIDING_PARAMS, BOTH_COLLIDING_LAYOUT, &storage);
+
+    CHECK(both.begin());
+    CHECK(*(const uint16_t*)both.value(ACQ_NAME) == 1); // Which of them was stored is unknown, both are defaults
+    CHECK(*(const uint16_t*)both.value(PAA_NAME) == 2);
+  }
+
+  RAMStorage storage;
+
+  {
+    Parameters both(BOTH_COLLIDING_PARAMS, BOTH_COLLIDING_LAYOUT, &storage);
+
+    CHECK(both.begin());
+    CHECK(both.fromString(ACQ_NAME, "7"));
+    CHECK(both.fromString(PAA_NAME, "8"));
+    CHECK(both.update());
+  }
+
+  Parameters one(ONE_COLLIDING_PARAMS, ONE_COLLIDING_LAYOUT, &storage);
+
+  CHECK(one.begin());
+  CHECK(*(const uint16_t*)one.value(ACQ_NAME) == 1); // Not 8 of "port_paa"
+}
+
+int main() {
+  RUN_TEST(testLegacyPacked);
+  RUN_TEST(testAligned);
+  RUN_TEST(testUpgrade);
+  RUN_TEST(testLargerImage);
+  RUN_TEST(testCrcMismatch);
+  RUN_TEST(testCollidingTags);
+  return unitResult();
+}
@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <vector>
+#include "Parameters.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char RETAIN_NAME[] PROGMEM = "retain";
+constexpr char ENABLED_NAME[] PROGMEM = "enabled";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_BOOL(ENABLED_NAME, NULL, true) // Shares the byte of bits with retain
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<uint16_t, 1> PORT;
+constexpr paramkey_t<bool, 2> RETAIN;
+constexpr paramkey_t<bool, 3> ENABLED;
+
+/*
+ * Records calls of one single-index and one all-parameters observer
+ */
+struct observed_t {
+  std::vector<uint16_t> port;
+  std::vector<uint16_t> all;
+
+  void observe(Parameters &params) {
+    params.onChange(PORT, [this](uint16_t index) {
+      port.push_back(index);
+    });
+    params.onChange(-1, [this](uint16_t index) {
+      all.push_back(index);
+    });
+  }
+  bool none() const {
+    return port.empty() && all.empty();
+  }
+  void clear() {
+    port.clear();
+    all.clear();
+  }
+};
+
+static void testStore() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+  observed_t observed;
+
+  observed.observe(params); // Before begin()
+  CHECK(params.begin());
+  CHECK(observed.none()); // Initial values are not changes
+  CHECK(params.fromString(SSID_NAME, "HomeNetwork"));
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(ENABLED, false));
+  CHECK(observed.none()); // Not before store
+  CHECK(params.update());
+  CHECK(observed.port == std::vector<uint16_t>({ 1 }));
+  CHECK(observed.all == std::vector<uint16_t>({ 0, 1, 3 })); // Once per field, not retain from the same byte
+  observed.clear();
+  CHECK(params.update());
+  CHECK(observed.none());
+}
+
+static void testSameValue() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+  observed_t observed;
+
+  CHECK(params.begin());
+  observed.observe(params); // After begin()
+  CHECK(params.set(PORT, (uint16_t)1883));
+  CHECK(params.set(RETAIN, false));
+  CHECK(params.fromString(SSID_NAME, ""));
+  CHECK(params.update());
+  CHECK(observed.none());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  CHECK(params.set(PORT, (uint16_t)1883)); // Back before store
+  CHECK(params.set(RETAIN, false));
+  CHECK(params.update());
+  CHECK(observed.none());
+}
+
+static void testCommit() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+  observed_t observed;
+
+  observed.observe(params);
+  CHECK(params.begin());
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  CHECK(params.update()); // Deferred to commit()
+  CHECK(observed.none());
+  CHECK(params.commit());
+  CHECK(observed.port == std::vector<uint16_t>({ 1 }));
+  CHECK(observed.all == std::vector<uint16_t>({ 1, 2 }));
+}
+
+static void testRollback() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+  observed_t observed;
+
+  observed.observe(params);
+  CHECK(params.begin());
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  params.rollback();
+  CHECK(params.update());
+  CHECK(observed.none());
+
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(PORT, (uint16_t)1883)); // Same value at commit
+  CHECK(params.commit());
+  CHECK(observed.none());
+}
+
+int main() {
+  RUN_TEST(testStore);
+  RUN_TEST(testSameValue);
+  RUN_TEST(testCommit);
+  RUN_TEST(testRollback);
+  return unitResult();
+}
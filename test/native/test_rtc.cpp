@@ -0,0 +1,214 @@
+#include <Arduino.h>
+#include "Parameters.h"
+#include "RtcParam.h"
+#include "unit.h"
+
+constexpr char BOOT_STATE_NAME[] PROGMEM = "boot_state";
+constexpr char PERSISTENT_NAME[] PROGMEM = "persist";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_BOOL(BOOT_STATE_NAME, NULL, false),
+  PARAM_BOOL(PERSISTENT_NAME, NULL, true)
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<bool, 0> BOOT_STATE;
+constexpr paramkey_t<bool, 1> PERSISTENT;
+
+const uint8_t RTC_RELAY_STATE = 0;
+const uint32_t PERSIST_DELAY = 60000;
+
+static RAMStorage storage; // Stands for flash, survives all simulated resets
+
+/*
+ * Same logic as bootState() of the firmware
+ */
+static bool bootState(Parameters &params, RtcParam<bool> &state) {
+  if (params.value(PERSISTENT))
+    return state.get();
+  return params.value(BOOT_STATE);
+}
+
+static void testPowerOnUsesFlash() {
+  ESP.rtcClear(); // Garbage in RTC memory after power loss
+  CHECK(! RtcStore::begin());
+
+  Parameters params(PARAMS, LAYOUT, &storage);
+  RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+  CHECK(params.begin());
+  state.begin();
+  CHECK(! bootState(params, state));
+  CHECK(! state.pending());
+}
+
+static void testRtcWinsOverFlash() {
+  uint32_t commits;
+
+  {
+    ESP.rtcClear();
+    RtcStore::begin();
+
+    Parameters params(PARAMS, LAYOUT, &storage);
+    RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+    CHECK(params.begin());
+    state.begin();
+    commits = storage.commits();
+    for (uint8_t i = 0; i < 10; ++i) { // Relay toggling does not touch flash
+      CHECK(state.set(i & 1));
+      state.handle();
+      params.handle();
+    }
+    CHECK(state.set(true));
+    state.handle(); // RTC memory is written in next loop() pass
+    CHECK(storage.commits() == commits);
+    CHECK(! params.value(BOOT_STATE)); // Flash still says OFF
+    CHECK(bootState(params, state));
+  }
+  { // Watchdog reset: RTC memory is kept, flash is stale
+    CHECK(RtcStore::begin());
+
+    Parameters params(PARAMS, LAYOUT, &storage);
+    RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+    CHECK(params.begin());
+    state.begin();
+    CHECK(! params.value(BOOT_STATE));
+    CHECK(bootState(params, state)); // RTC wins
+    CHECK(state.pending()); // Not stored value is scheduled again
+    CHECK(storage.commits() == commits);
+
+    delay(PERSIST_DELAY);
+    state.handle();
+    params.flush();
+    CHECK(params.value(BOOT_STATE));
+    CHECK(storage.commits() == commits + 1);
+    CHECK(! state.pending());
+  }
+}
+
+static void testStableStateStoredOnce() {
+  ESP.rtcClear();
+  RtcStore::begin();
+
+  Parameters params(PARAMS, LAYOUT, &storage);
+  RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+  CHECK(params.begin());
+  state.begin();
+
+  uint32_t commits = storage.commits();
+
+  CHECK(state.set(false));
+  delay(PERSIST_DELAY / 2);
+  state.handle();
+  CHECK(state.pending()); // Too early
+  CHECK(state.set(true)); // Changed again, delay restarts
+  delay(PERSIST_DELAY / 2);
+  state.handle();
+  CHECK(state.pending());
+  CHECK(state.set(false));
+  CHECK(state.save()); // Before planned restart
+  params.flush();
+  CHECK(! params.value(BOOT_STATE));
+  CHECK(storage.commits() == commits + 1);
+  CHECK(! state.pending());
+
+  ESP.rtcClear(); // Power loss after save() keeps the last state
+  CHECK(! RtcStore::begin());
+  CHECK(! bootState(params, state));
+}
+
+static void testBatchedRtcWrites() {
+  ESP.rtcClear();
+  RtcStore::begin();
+
+  Parameters params(PARAMS, LAYOUT, &storage);
+  RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+  CHECK(params.begin());
+  state.begin();
+
+  uint32_t writes = ESP.rtcWrites();
+
+  for (uint8_t i = 0; i < 10; ++i)
+    CHECK(state.set(i & 1));
+  CHECK(ESP.rtcWrites() == writes);
+  state.handle();
+  CHECK(ESP.rtcWrites() == writes + 1); // All toggles at once
+  state.handle();
+  CHECK(ESP.rtcWrites() == writes + 1); // Nothing changed
+}
+
+static void testSetupEditWins() {
+  ESP.rtcClear();
+  RtcStore::begin();
+  {
+    Parameters params(PARAMS, LAYOUT, &storage);
+    RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+    CHECK(params.begin());
+    state.begin();
+    CHECK(params.onChange(BOOT_STATE, [&](uint16_t) { // Same as observer of the firmware
+      state.reload();
+    }));
+    CHECK(state.set(true));
+    CHECK(state.save());
+    CHECK(params.value(BOOT_STATE));
+    CHECK(params.fromString(BOOT_STATE_NAME, "false")); // Edited on /setup page
+    CHECK(params.update());
+    CHECK(! state.get());
+  }
+  { // Soft restart: RTC memory is kept, but must not bring back old state
+    CHECK(RtcStore::begin());
+
+    Parameters params(PARAMS, LAYOUT, &storage);
+    RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+    CHECK(params.begin());
+    state.begin();
+    CHECK(! bootState(params, state));
+    CHECK(! state.pending());
+  }
+}
+
+static void testUnstoredEditBeforeRestart() {
+  ESP.rtcClear();
+  RtcStore::begin();
+  {
+    Parameters params(PARAMS, LAYOUT, &storage);
+    RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+    CHECK(params.begin());
+    state.begin();
+    CHECK(! params.value(BOOT_STATE));
+    CHECK(state.set(true));
+    CHECK(state.set(false)); // Toggled back, write to flash is still pending
+    state.handle();
+    CHECK(state.pending());
+    CHECK(params.fromString(BOOT_STATE_NAME, "true")); // Edited on /setup page, deferred commit not done yet
+    CHECK(state.save()); // Before planned restart
+    CHECK(params.flush());
+    CHECK(params.value(BOOT_STATE));
+  }
+  CHECK(RtcStore::begin());
+
+  Parameters params(PARAMS, LAYOUT, &storage);
+  RtcParam<bool> state(params, BOOT_STATE, RTC_RELAY_STATE, PERSIST_DELAY);
+
+  CHECK(params.begin());
+  state.begin();
+  CHECK(bootState(params, state));
+}
+
+int main() {
+  RUN_TEST(testPowerOnUsesFlash);
+  RUN_TEST(testRtcWinsOverFlash);
+  RUN_TEST(testStableStateStoredOnce);
+  RUN_TEST(testBatchedRtcWrites);
+  RUN_TEST(testSetupEditWins);
+  RUN_TEST(testUnstoredEditBeforeRestart);
+  return unitResult();
+}
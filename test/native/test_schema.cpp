@@ -0,0 +1,141 @@
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include "Parameters.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char SSID_TITLE[] PROGMEM = "WiFi SSID";
+constexpr char PSWD_NAME[] PROGMEM = "pswd";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char OTHER_PORT_NAME[] PROGMEM = "other_port";
+constexpr char NOTE_NAME[] PROGMEM = "note";
+constexpr char CERT_NAME[] PROGMEM = "cert";
+constexpr char RETAIN_NAME[] PROGMEM = "retain";
+constexpr char ENABLED_NAME[] PROGMEM = "enabled";
+constexpr char SWITCH_NAME[] PROGMEM = "switch";
+constexpr char YES_PSTR[] PROGMEM = "yes";
+constexpr char NO_PSTR[] PROGMEM = "no";
+constexpr char OTHER_YES_PSTR[] PROGMEM = "yes"; // Same content in another array
+constexpr char STATE_NAME[] PROGMEM = "state";
+constexpr char MODE_NAME[] PROGMEM = "mode";
+constexpr char TZ_NAME[] PROGMEM = "tz";
+constexpr char CALIBRATION_NAME[] PROGMEM = "calibration";
+constexpr char IP_NAME[] PROGMEM = "ip";
+constexpr char SECRET_NAME[] PROGMEM = "secret";
+
+const char OFF_PSTR[] PROGMEM = "OFF";
+const char ON_PSTR[] PROGMEM = "ON";
+const char *const STATES[] PROGMEM = { OFF_PSTR, ON_PSTR };
+const char AUTO_PSTR[] PROGMEM = "auto";
+const char MANUAL_PSTR[] PROGMEM = "manual";
+const char *const MODES[] PROGMEM = { AUTO_PSTR, MANUAL_PSTR };
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, SSID_TITLE, 33, NULL),
+  PARAM_PASSWORD(PSWD_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_U16(OTHER_PORT_NAME, NULL, 8883),
+  PARAM_STR_CUSTOM(NOTE_NAME, NULL, 65, NULL, EDITOR_TEXTAREA(32, 2, 64, false, false, true)),
+  PARAM_STR_CUSTOM(CERT_NAME, NULL, 1025, NULL, EDITOR_TEXTAREA(64, 16, 1024, false, true, false)),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_BOOL_CUSTOM(ENABLED_NAME, NULL, true, EDITOR_CHECKBOX(YES_PSTR, NO_PSTR, false, false, false)),
+  PARAM_BOOL_CUSTOM(SWITCH_NAME, NULL, true, EDITOR_CHECKBOX(OTHER_YES_PSTR, NO_PSTR, false, false, false)),
+  PARAM_BOOL_CUSTOM(STATE_NAME, NULL, false, EDITOR_RADIO(2, BOOLS, STATES, false, false, false)),
+  PARAM_U8_CUSTOM(MODE_NAME, NULL, 0, 0, 1, EDITOR_SELECT(1, 2, MODES, NULL, true, false)),
+  PARAM_I8(TZ_NAME, NULL, 3),
+  PARAM_FLOAT(CALIBRATION_NAME, NULL, 1.0),
+  PARAM_IP_CUSTOM(IP_NAME, NULL, 192, 168, 1, 100, EDITOR_HIDDEN()),
+  PARAM_BINARY_CUSTOM(SECRET_NAME, NULL, 16, NULL, EDITOR_NONE())
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+PARAMS_SCHEMA(SCHEMA, PARAMS);
+
+constexpr paramkey_t<uint16_t, 2> PORT;
+constexpr paramkey_t<bool, 8> SWITCH;
+constexpr paramkey_t<float, 12> CALIBRATION;
+
+static std::string webPage(Parameters &params) {
+  ESP8266WebServer http;
+
+  http.request(HTTP_GET, "/");
+  params.handleWebPage(http, NULL);
+  return http.client().output();
+}
+
+static void testSameEditors() {
+  RAMStorage tableStorage, schemaStorage;
+  Parameters table(PARAMS, LAYOUT, &tableStorage);
+  Parameters schema(SCHEMA, LAYOUT, &schemaStorage);
+
+  CHECK(table.begin());
+  CHECK(schema.begin());
+  CHECK(webPage(table) == webPage(schema));
+  CHECK(webPage(schema).find("name=\"cert\" cols=64 rows=16 maxlength=1024 required") != std::string::npos);
+  CHECK(webPage(schema).find("value=\"yes\"") != std::string::npos);
+}
+
+static void testSameValues() {
+  RAMStorage storage;
+  Parameters table(PARAMS, LAYOUT, &storage);
+
+  CHECK(table.begin());
+  CHECK(table.fromString(SSID_NAME, "HomeNetwork"));
+  CHECK(table.update());
+
+  Parameters schema(SCHEMA, LAYOUT, &storage); // The same image is valid for both
+
+  CHECK(schema.begin());
+  CHECK(! strcmp((const char*)schema.value(SSID_NAME), "HomeNetwork"));
+  CHECK(schema.value(PORT) == 1883);
+  CHECK(schema.value(SWITCH));
+  CHECK(schema.value(CALIBRATION) == 1.0);
+  CHECK(schema.size(CERT_NAME) == 1025);
+  CHECK(schema.type(schema.find(IP_NAME)) == paraminfo_t::PARAM_IP);
+  CHECK(! schema.fromString(PORT_NAME, "65536"));
+  CHECK(schema.toString(IP_NAME) == "192.168.1.100");
+
+  paraminfo_t info, schemaInfo;
+
+  for (uint16_t i = 0; i < table.count(); ++i) {
+    CHECK(table.getInfo(i, info));
+    CHECK(! memcmp(&info, &PARAMS[i], sizeof(paraminfo_t)));
+    CHECK(schema.getInfo(i, schemaInfo));
+    CHECK(! memcmp(&schemaInfo, &info, sizeof(paramdesc_t)));
+    CHECK(schemaInfo.editor.type == info.editor.type);
+  }
+  CHECK(schema.getInfo(5, info)); // cert
+  CHECK(info.size == 1025);
+  CHECK(info.editor.textarea.cols == 64);
+  CHECK(info.editor.textarea.maxlength == 1024);
+  CHECK(info.editor.required);
+  CHECK(schema.getInfo(8, info)); // switch
+  CHECK(! strcmp_P("yes", info.editor.checkbox.checkedvalue));
+  CHECK(! schema.getInfo(schema.count(), info));
+}
+
+static void testCompact() {
+  CHECK(sizeof(SCHEMA.params[0]) + sizeof(SCHEMA.editors.index[0]) < sizeof(PARAMS[0]));
+  CHECK(sizeof(SCHEMA) < sizeof(PARAMS));
+  CHECK(SCHEMA.editors.index[2] == SCHEMA.editors.index[3]); // Equal records are shared
+  CHECK(SCHEMA.editors.index[7] == SCHEMA.editors.index[8]); // Checkbox strings are compared by content
+  CHECK(SCHEMA.editors.index[6] != SCHEMA.editors.index[7]);
+  CHECK(SCHEMA.editors.count == 3); // BOOLS, STATES, MODES
+
+  uint16_t yes = 0;
+
+  for (uint16_t offset = 0; offset + 4 <= SCHEMA.editors.size; ++offset) {
+    if (! memcmp(&SCHEMA.editors.data[offset], "yes", 4))
+      ++yes;
+  }
+  CHECK(yes == 1);
+  printf("%u parameters: table %u bytes, schema %u bytes (%u bytes of editors)\n", (unsigned)ARRAY_SIZE(PARAMS),
+    (unsigned)sizeof(PARAMS), (unsigned)sizeof(SCHEMA), SCHEMA.editors.size);
+}
+
+int main() {
+  RUN_TEST(testSameEditors);
+  RUN_TEST(testSameValues);
+  RUN_TEST(testCompact);
+  return unitResult();
+}
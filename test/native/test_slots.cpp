@@ -0,0 +1,119 @@
+#include <Arduino.h>
+#include "Parameters.h"
+#include "ParamSlots.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char COUNTER_NAME[] PROGMEM = "counter";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_U32(COUNTER_NAME, NULL, 0)
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<uint16_t, 1> PORT;
+constexpr paramkey_t<uint32_t, 2> COUNTER;
+
+const uint32_t SECTOR = 16;
+
+static void testSeed() {
+  ESP.flashClear();
+  {
+    EEPROMStorage eeprom;
+    Parameters params(PARAMS, LAYOUT, &eeprom);
+
+    CHECK(params.begin());
+    params.set(PORT, (uint16_t)8883);
+    CHECK(params.update());
+  }
+
+  EEPROMStorage eeprom;
+  ParamSlots slots(SECTOR, &eeprom);
+  Parameters params(PARAMS, LAYOUT, &slots);
+
+  CHECK(params.begin());
+  CHECK(params.value(PORT) == 8883); // Both slots are empty, image of previous firmware is taken
+  CHECK(! ESP.flashErases(SECTOR));
+  CHECK(! ESP.flashErases(SECTOR + 1));
+}
+
+static void testNewestGeneration() {
+  uint32_t erases;
+
+  ESP.flashClear();
+  {
+    ParamSlots slots(SECTOR);
+    Parameters params(PARAMS, LAYOUT, &slots);
+
+    CHECK(params.begin()); // Defaults are committed into the first slot
+    erases = ESP.flashErases(SECTOR) + ESP.flashErases(SECTOR + 1);
+    for (uint32_t i = 1; i <= 5; ++i) {
+      params.set(COUNTER, i);
+      CHECK(params.update());
+    }
+  }
+  CHECK(ESP.flashErases(SECTOR) + ESP.flashErases(SECTOR + 1) == erases + 5); // One erase per commit
+  CHECK(ESP.flashErases(SECTOR) == ESP.flashErases(SECTOR + 1)); // Slots alternate
+
+  ParamSlots slots(SECTOR);
+  Parameters params(PARAMS, LAYOUT, &slots);
+
+  CHECK(params.begin());
+  CHECK(params.value(COUNTER) == 5);
+}
+
+/*
+ * Cuts power after every possible number of bytes of one commit (erase included): as the header
+ * is written last, the next begin() must see the previous image until the commit completes
+ */
+static void testTornWrite() {
+  for (int32_t cut = 0; ; cut += 4) {
+    ESP.flashClear();
+
+    bool completed;
+
+    {
+      ParamSlots slots(SECTOR);
+      Parameters params(PARAMS, LAYOUT, &slots);
+
+      CHECK(params.begin());
+      CHECK(params.fromString(SSID_NAME, "HomeNetwork"));
+      for (uint32_t i = 0; i <= 1; ++i) { // Both slots hold valid images, older one is overwritten
+        params.set(COUNTER, i);
+        CHECK(params.update());
+      }
+      ESP.flashFailAfter(cut);
+      params.set(COUNTER, (uint32_t)2);
+      completed = params.update();
+      ESP.flashFailAfter(-1);
+    }
+
+    ParamSlots slots(SECTOR);
+    Parameters params(PARAMS, LAYOUT, &slots);
+
+    CHECK(params.begin());
+    CHECK(params.value(COUNTER) == (completed ? 2 : 1));
+    CHECK(! strcmp((const char*)params.value(SSID_NAME), "HomeNetwork"));
+    params.set(COUNTER, (uint32_t)3);
+    CHECK(params.update());
+
+    ParamSlots reopened(SECTOR);
+    Parameters restored(PARAMS, LAYOUT, &reopened);
+
+    CHECK(restored.begin());
+    CHECK(restored.value(COUNTER) == 3);
+    if (completed)
+      break;
+  }
+}
+
+int main() {
+  RUN_TEST(testSeed);
+  RUN_TEST(testNewestGeneration);
+  RUN_TEST(testTornWrite);
+  return unitResult();
+}
@@ -0,0 +1,98 @@
+#include <Arduino.h>
+#include <StreamString.h>
+#include "Parameters.h"
+#include "unit.h"
+
+constexpr char KEY_NAME[] PROGMEM = "key";
+constexpr char IV_NAME[] PROGMEM = "iv";
+constexpr char USER_NAME[] PROGMEM = "user";
+constexpr char HOST_NAME[] PROGMEM = "host";
+constexpr char PORT_NAME[] PROGMEM = "port";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_BINARY(KEY_NAME, NULL, 4, NULL),
+  PARAM_BINARY(IV_NAME, NULL, 3, NULL),
+  PARAM_STR(USER_NAME, NULL, 5, NULL),
+  PARAM_STR(HOST_NAME, NULL, 5, NULL),
+  PARAM_U16(PORT_NAME, NULL, 0)
+};
+
+static RAMStorage storage;
+static Parameters params(PARAMS, ARRAY_SIZE(PARAMS), &storage);
+
+static bool binaryIs(const char *name, const uint8_t *data, uint16_t size) {
+  return ! memcmp(params.value(name), data, size);
+}
+
+static void testBinaryPaddedThenFull() {
+  const uint8_t KEY[] = { 0x01, 0x02, 0x03, 0x04 };
+  const uint8_t IV[] = { 0x05, 0x06, 0x07 };
+  StreamString stream;
+
+  stream.concat("AQIDBA==\r\nBQYH\n8080\n"); // Padded 4 bytes, full 3 bytes without padding
+  CHECK(params.fromStream(KEY_NAME, stream));
+  CHECK(binaryIs(KEY_NAME, KEY, sizeof(KEY)));
+  CHECK(params.fromStream(IV_NAME, stream));
+  CHECK(binaryIs(IV_NAME, IV, sizeof(IV)));
+  CHECK(params.fromStream(PORT_NAME, stream));
+  CHECK(*(const uint16_t*)params.value(PORT_NAME) == 8080);
+  CHECK(! stream.available());
+}
+
+static void testBinaryOverflow() {
+  const uint8_t IV[] = { 0x01, 0x02, 0x03 };
+  StreamString stream;
+
+  stream.concat("AQIDBAUG\r\n443\r\n"); // 6 bytes into 3 bytes field, tail of line is dropped
+  CHECK(params.fromStream(IV_NAME, stream));
+  CHECK(binaryIs(IV_NAME, IV, sizeof(IV)));
+  CHECK(params.fromStream(PORT_NAME, stream));
+  CHECK(*(const uint16_t*)params.value(PORT_NAME) == 443);
+  CHECK(! stream.available());
+}
+
+static void testStrFullThenShort() {
+  StreamString stream;
+
+  stream.concat("root\r\nab\n"); // Exactly field size - 1 chars, delimiter must still be consumed
+  CHECK(params.fromStream(USER_NAME, stream));
+  CHECK(! strcmp((const char*)params.value(USER_NAME), "root"));
+  CHECK(params.fromStream(HOST_NAME, stream));
+  CHECK(! strcmp((const char*)params.value(HOST_NAME), "ab"));
+  CHECK(! stream.available());
+}
+
+static void testStrTruncated() {
+  StreamString stream;
+
+  stream.concat("administrator\n1883\n");
+  CHECK(params.fromStream(USER_NAME, stream));
+  CHECK(! strcmp((const char*)params.value(USER_NAME), "admi"));
+  CHECK(params.fromStream(PORT_NAME, stream));
+  CHECK(*(const uint16_t*)params.value(PORT_NAME) == 1883);
+  CHECK(! stream.available());
+}
+
+static void testInvalidLineSkipped() {
+  StreamString stream;
+
+  stream.concat("A!ID\n123456789012345678901234567890123\nhost\n");
+  CHECK(! params.fromStream(KEY_NAME, stream));
+  CHECK(! params.fromStream(PORT_NAME, stream)); // Too long for a number
+  CHECK(params.fromStream(HOST_NAME, stream));
+  CHECK(! strcmp((const char*)params.value(HOST_NAME), "host"));
+  CHECK(! stream.available());
+}
+
+int main() {
+  if (! params.begin()) {
+    printf("Parameters begin FAIL!\n");
+    return 1;
+  }
+  RUN_TEST(testBinaryPaddedThenFull);
+  RUN_TEST(testBinaryOverflow);
+  RUN_TEST(testStrFullThenShort);
+  RUN_TEST(testStrTruncated);
+  RUN_TEST(testInvalidLineSkipped);
+  return unitResult();
+}
@@ -0,0 +1,125 @@
+#include <Arduino.h>
+#include "Parameters.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char RETAIN_NAME[] PROGMEM = "retain";
+constexpr char LEVEL_NAME[] PROGMEM = "level";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_BOOL(RETAIN_NAME, NULL, false),
+  PARAM_U8_CUSTOM(LEVEL_NAME, NULL, 5, 0, 10, EDITOR_TEXT(2, 2, false, false, false))
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+constexpr paramkey_t<const char*, 0> SSID;
+constexpr paramkey_t<uint16_t, 1> PORT;
+constexpr paramkey_t<bool, 2> RETAIN;
+constexpr paramkey_t<uint8_t, 3> LEVEL;
+
+static void checkDefaults(Parameters &params) {
+  CHECK(! *params.value(SSID));
+  CHECK(params.value(PORT) == 1883);
+  CHECK(! params.value(RETAIN));
+  CHECK(params.value(LEVEL) == 5);
+}
+
+static void testCommit() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  uint32_t commits = storage.commits();
+
+  CHECK(params.beginTransaction());
+  CHECK(! params.beginTransaction()); // Not nested
+  CHECK(params.fromString(SSID_NAME, "HomeNetwork"));
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  CHECK(params.value(PORT) == 8883); // Transaction sees its own changes
+  CHECK(params.commit());
+  CHECK(! params.inTransaction());
+  CHECK(storage.commits() == commits + 1); // All of them at once
+
+  Parameters restored(PARAMS, LAYOUT, &storage);
+
+  CHECK(restored.begin());
+  CHECK(! strcmp(restored.value(SSID), "HomeNetwork"));
+  CHECK(restored.value(PORT) == 8883);
+  CHECK(restored.value(RETAIN));
+}
+
+static void testRollback() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  uint32_t commits = storage.commits();
+
+  CHECK(params.beginTransaction());
+  CHECK(params.fromString(SSID_NAME, "HomeNetwork"));
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(RETAIN, true));
+  params.rollback();
+  CHECK(! params.inTransaction());
+  checkDefaults(params);
+  CHECK(params.update());
+  CHECK(storage.commits() == commits); // Nothing to store
+}
+
+static void testOutOfRange() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  uint32_t commits = storage.commits();
+
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.set(LEVEL, (uint8_t)11)); // set() does not check range, commit() does
+  CHECK(! params.commit());
+  CHECK(! params.inTransaction());
+  checkDefaults(params);
+  CHECK(storage.commits() == commits);
+
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(! params.fromString(LEVEL_NAME, "11"));
+  CHECK(! params.commit()); // Failed parse fails the whole transaction
+  checkDefaults(params);
+  CHECK(params.update());
+  CHECK(storage.commits() == commits);
+}
+
+static void testUpdateInTransaction() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  uint32_t commits = storage.commits();
+
+  CHECK(params.beginTransaction());
+  CHECK(params.set(PORT, (uint16_t)8883));
+  CHECK(params.update()); // Deferred to commit()
+  CHECK(! params.flush());
+  CHECK(storage.commits() == commits);
+  CHECK(params.commit());
+  CHECK(storage.commits() == commits + 1);
+  CHECK(params.value(PORT) == 8883);
+}
+
+int main() {
+  RUN_TEST(testCommit);
+  RUN_TEST(testRollback);
+  RUN_TEST(testOutOfRange);
+  RUN_TEST(testUpdateInTransaction);
+  return unitResult();
+}
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <string>
+#include "Parameters.h"
+#include "WebAssets.h"
+#include "unit.h"
+
+constexpr char SSID_NAME[] PROGMEM = "ssid";
+constexpr char PORT_NAME[] PROGMEM = "port";
+constexpr char CALIBRATION_NAME[] PROGMEM = "calibration";
+constexpr char NOTE_NAME[] PROGMEM = "note";
+
+constexpr paraminfo_t PARAMS[] PROGMEM = {
+  PARAM_STR(SSID_NAME, NULL, 33, NULL),
+  PARAM_U16(PORT_NAME, NULL, 1883),
+  PARAM_FLOAT(CALIBRATION_NAME, NULL, 1.0),
+  PARAM_STR_CUSTOM(NOTE_NAME, NULL, 65, NULL, EDITOR_TEXTAREA(32, 2, 64, false, false, false))
+};
+
+PARAMS_LAYOUT(LAYOUT, PARAMS);
+
+static bool contains(const std::string &page, const char *str) {
+  return page.find(str) != std::string::npos;
+}
+
+static std::string webPage(Parameters &params, const webasset_t *script) {
+  ESP8266WebServer http;
+
+  http.request(HTTP_GET, "/setup");
+  params.handleWebPage(http, script);
+  return http.client().output();
+}
+
+static void testInlineScript() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  std::string page = webPage(params, NULL);
+
+  CHECK(! contains(page, "?js"));
+  CHECK(contains(page, "openUrl('/setup','delete')")); // Every handler the page calls is defined in it
+  CHECK(contains(page, "function openUrl("));
+  CHECK(contains(page, "onblur=\"checkInt(this,"));
+  CHECK(contains(page, "function checkInt("));
+  CHECK(contains(page, "onblur=\"checkFloat(this,"));
+  CHECK(contains(page, "function checkFloat("));
+  CHECK(contains(page, "onkeydown=\"processTab(this,event);\""));
+  CHECK(contains(page, "function processTab("));
+  CHECK(page.find("</script>") < page.find("<form"));
+}
+
+static void testScriptAsset() {
+  RAMStorage storage;
+  Parameters params(PARAMS, LAYOUT, &storage);
+
+  CHECK(params.begin());
+
+  std::string page = webPage(params, &WEB_PARAMS_JS);
+
+  CHECK(contains(page, "<script type=\"text/javascript\" src=\"/setup?js\"></script>"));
+  CHECK(! contains(page, "function openUrl("));
+
+  ESP8266WebServer http;
+
+  http.request(HTTP_GET, "/setup");
+  http.addArg("js", "");
+  params.handleWebPage(http, &WEB_PARAMS_JS);
+  CHECK(contains(http.client().output(), "200"));
+  CHECK(contains(http.client().output(), "Content-Encoding: gzip"));
+  CHECK(contains(http.client().output(), WEB_PARAMS_JS_ETAG));
+
+  http.request(HTTP_GET, "/setup");
+  http.addArg("js", "");
+  http.addHeader("If-None-Match", WEB_PARAMS_JS_ETAG);
+  params.handleWebPage(http, &WEB_PARAMS_JS);
+  CHECK(contains(http.client().output(), "304"));
+  CHECK(! contains(http.client().output(), "Content-Encoding: gzip"));
+}
+
+int main() {
+  RUN_TEST(testInlineScript);
+  RUN_TEST(testScriptAsset);
+  return unitResult();
+}
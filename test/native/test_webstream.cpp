@@ -0,0 +1,133 @@
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <string>
+#include <vector>
+#include "WebStream.h"
+#include "unit.h"
+
+static const uint16_t CHUNK_SIZE = 1460 - 5 - 2; // TCP_MSS without chunk size line and CRLF
+
+static const char TEXTPLAIN_PSTR[] PROGMEM = "text/plain";
+
+/*
+ * Splits chunked response content into chunks, false if framing is broken or there is no last chunk
+ */
+static bool parseChunks(const std::string &output, std::vector<uint16_t> &sizes, std::string &content) {
+  size_t pos = output.find("\r\n\r\n");
+
+  sizes.clear();
+  content.clear();
+  if (pos == std::string::npos)
+    return false;
+  pos += 4;
+  while (pos < output.length()) {
+    size_t eol = output.find("\r\n", pos);
+
+    if (eol == std::string::npos)
+      return false;
+
+    unsigned long size = strtoul(output.substr(pos, eol - pos).c_str(), NULL, 16);
+
+    pos = eol + 2;
+    if (! size)
+      return output.compare(pos, std::string::npos, "\r\n") == 0; // Last chunk ends the response
+    if ((pos + size + 2 > output.length()) || output.compare(pos + size, 2, "\r\n"))
+      return false;
+    sizes.push_back(size);
+    content.append(output, pos, size);
+    pos += size + 2;
+  }
+  return false;
+}
+
+static std::string pattern(size_t size, char first = 'a') {
+  std::string result;
+
+  for (size_t i = 0; i < size; ++i)
+    result += (char)(first + i % 26);
+  return result;
+}
+
+static void testLargeWrite() {
+  ESP8266WebServer http;
+  std::vector<uint16_t> sizes;
+  std::string content, data = pattern(5000);
+
+  http.request(HTTP_GET, "/");
+  {
+    WebStream stream(http);
+
+    CHECK(stream.begin(200, TEXTPLAIN_PSTR));
+    CHECK(stream.write((const uint8_t*)data.data(), data.length()) == data.length());
+  } // end() by destructor
+  CHECK(parseChunks(http.client().output(), sizes, content));
+  CHECK(sizes == std::vector<uint16_t>({ CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE, 5000 - 3 * CHUNK_SIZE }));
+  CHECK(content == data);
+}
+
+static void testEmptyEnd() {
+  ESP8266WebServer http;
+  std::vector<uint16_t> sizes;
+  std::string content;
+  WebStream stream(http);
+
+  http.request(HTTP_GET, "/");
+  CHECK(stream.begin(200, TEXTPLAIN_PSTR));
+  CHECK(! stream.begin(200, TEXTPLAIN_PSTR)); // Already active
+  stream.flush(); // Nothing to send, must not send empty chunk that ends response
+  stream.end();
+  CHECK(parseChunks(http.client().output(), sizes, content));
+  CHECK(sizes.empty());
+
+  size_t length = http.client().output().length();
+
+  stream.end(); // Only once
+  CHECK(stream.print("late") == 0);
+  CHECK(http.client().output().length() == length);
+}
+
+static void testBoundaryMidWrite() {
+  ESP8266WebServer http;
+  std::vector<uint16_t> sizes;
+  std::string content, first = pattern(1000), second = pattern(1000, 'A'), third = pattern(CHUNK_SIZE - 547);
+
+  http.request(HTTP_GET, "/");
+  {
+    WebStream stream(http);
+
+    CHECK(stream.begin(200, TEXTPLAIN_PSTR));
+    CHECK(stream.write((const uint8_t*)first.data(), first.length()) == first.length());
+    CHECK(stream.write((const uint8_t*)second.data(), second.length()) == second.length()); // Fills chunk at 453
+    CHECK(stream.write((const uint8_t*)third.data(), third.length()) == third.length()); // Exactly fills next one
+    stream.end();
+  }
+  CHECK(parseChunks(http.client().output(), sizes, content));
+  CHECK(sizes == std::vector<uint16_t>({ CHUNK_SIZE, CHUNK_SIZE }));
+  CHECK(content == first + second + third);
+}
+
+static void testSmallWrites() {
+  ESP8266WebServer http;
+  std::vector<uint16_t> sizes;
+  std::string content, data = pattern(3000);
+
+  http.request(HTTP_GET, "/");
+  {
+    WebStream stream(http);
+
+    CHECK(stream.begin(200, TEXTPLAIN_PSTR));
+    for (size_t i = 0; i < data.length(); ++i)
+      CHECK(stream.write(data[i]) == 1);
+  }
+  CHECK(parseChunks(http.client().output(), sizes, content));
+  CHECK(sizes == std::vector<uint16_t>({ CHUNK_SIZE, CHUNK_SIZE, 3000 - 2 * CHUNK_SIZE }));
+  CHECK(content == data);
+}
+
+int main() {
+  RUN_TEST(testLargeWrite);
+  RUN_TEST(testEmptyEnd);
+  RUN_TEST(testBoundaryMidWrite);
+  RUN_TEST(testSmallWrites);
+  return unitResult();
+}
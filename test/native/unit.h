@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * Minimal harness of host tests: failed CHECK() is reported and the test goes on,
+ * process exit code is nonzero if anything failed (for ctest)
+ */
+
+#include <stdio.h>
+
+static int unitFailures = 0;
+
+#define CHECK(expr) \
+  do { \
+    if (! (expr)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+      ++unitFailures; \
+    } \
+  } while (0)
+
+#define RUN_TEST(test) \
+  do { \
+    int failures = unitFailures; \
+    test(); \
+    printf("%s %s\n", failures == unitFailures ? "PASS" : "FAIL", #test); \
+  } while (0)
+
+static inline int unitResult() {
+  return unitFailures ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+# Pre-build script: compresses files from web/ and embeds them into include/WebAssets.h
+# as PROGMEM blobs with ETag made of content hash, to be sent by sendWebAsset()
+
+import gzip
+import hashlib
+import os
+import re
+
+try:
+    Import("env")
+    PROJECT_DIR = env.subst("$PROJECT_DIR")
+except NameError: # Run standalone
+    PROJECT_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+WEB_DIR = os.path.join(PROJECT_DIR, "web")
+HEADER = os.path.join(PROJECT_DIR, "include", "WebAssets.h")
+
+TYPES = {
+    ".html": "text/html",
+    ".js": "text/javascript",
+    ".css": "text/css",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+}
+
+def asset_name(filename):
+    return "WEB_" + re.sub(r"[^0-9A-Za-z]", "_", filename).upper()
+
+def generate():
+    lines = [
+        "// Generated by tools/web_assets.py from web/, do not edit!",
+        "#pragma once",
+        "",
+        "#include \"WebAsset.h\"",
+        "",
+    ]
+    for filename in sorted(os.listdir(WEB_DIR)):
+        ext = os.path.splitext(filename)[1].lower()
+        if ext not in TYPES:
+            continue
+        with open(os.path.join(WEB_DIR, filename), "rb") as f:
+            content = f.read()
+        data = gzip.compress(content, 9, mtime=0) # mtime=0 keeps output reproducible
+        name = asset_name(filename)
+        lines.append("// %s: %u bytes, gzipped %u bytes" % (filename, len(content), len(data)))
+        lines.append("static const uint8_t %s_DATA[] PROGMEM = {" % name)
+        for i in range(0, len(data), 16):
+            lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+        lines.append("};")
+        lines.append("static const char %s_TYPE[] PROGMEM = \"%s\";" % (name, TYPES[ext]))
+        lines.append("static const char %s_ETAG[] PROGMEM = \"\\\"%s\\\"\";" % (name, hashlib.sha1(content).hexdigest()[:16]))
+        lines.append("static const webasset_t %s = { %s_DATA, sizeof(%s_DATA), %s_TYPE, %s_ETAG };" % (name, name, name, name, name))
+        lines.append("")
+    text = "\n".join(lines)
+    if os.path.exists(HEADER):
+        with open(HEADER, "r") as f:
+            if f.read() == text:
+                return # Do not touch to avoid needless rebuild
+    with open(HEADER, "w") as f:
+        f.write(text)
+
+generate()
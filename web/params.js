@@ -0,0 +1,59 @@
+function getXmlHttpRequest(){
+let x;
+try{
+x=new ActiveXObject("Msxml2.XMLHTTP");
+}catch(e){
+try{
+x=newActiveXObject("Microsoft.XMLHTTP");
+}catch(E){
+x=false;
+}
+}
+if((!x)&&(typeof XMLHttpRequest!='undefined')){
+x=new XMLHttpRequest();
+}
+return x;
+}
+function openUrl(u,m){
+let x=getXmlHttpRequest();
+x.open(m,u,false);
+x.send(null);
+if(x.status!=200){
+alert(x.responseText);
+return false;
+}
+return true;
+}
+function checkInt(e,d,m,x){
+let n=parseInt(e.value);
+if(isNaN(n)){
+n=d;
+}else{
+if(n<m)n=m;
+if(n>x)n=x;
+}
+e.value=n.toString();
+}
+function checkFloat(e,d,m,x){
+let n=parseFloat(e.value);
+if(isNaN(n)){
+n=d;
+}else{
+if((!isNaN(m))&&(n<m))n=m;
+if((!isNaN(x))&&(n>x))n=x;
+}
+if(isNaN(n)){e.value="";
+}else{
+e.value=n.toString();
+}
+}
+function processTab(t,e){
+if(e.which==9){
+let start=t.selectionStart;
+let end=t.selectionEnd;
+t.value=t.value.substr(0,start)+'	'+t.value.substr(end);
+t.selectionStart=t.selectionEnd=start+1;
+e.preventDefault();
+return false;
+}
+}